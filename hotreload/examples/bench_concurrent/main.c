@@ -0,0 +1,185 @@
+#include "hotreload.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define FN_COUNT    64
+#define MAX_THREADS 256
+#define BUILD_DIR   ".hotreload_bench_mt"
+#define MODULE_SRC  BUILD_DIR "/bench_module.c"
+
+typedef int (*bench_fn)(int);
+
+typedef struct {
+    volatile unsigned long long lookups;
+    volatile unsigned long long errors;
+    volatile double             worst_ns;
+    char                        pad[64];
+} worker_t;
+
+static hr_module_t* g_mod;
+static char         g_names[FN_COUNT][32];
+static volatile int g_stop;
+static worker_t     g_workers[MAX_THREADS];
+
+static double now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart * 1e9 / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+static void sleep_ms(int ms) {
+#ifdef _WIN32
+    Sleep((DWORD)ms);
+#else
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static int write_module(int generation) {
+    FILE* f = fopen(MODULE_SRC, "w");
+    if (!f) return 0;
+    for (int i = 0; i < FN_COUNT; i++)
+        fprintf(f, "int bench_fn_%02d(int x) { return x + %d; }\n", i, i + generation * 1000);
+    fclose(f);
+    return 1;
+}
+
+/* Every lookup must return some generation of the function: x + i + k*1000. */
+static void run_worker(worker_t* w) {
+    hr_thread_register();
+    int x = 0;
+    while (!g_stop) {
+        for (int i = 0; i < FN_COUNT; i++) {
+            int timed = (w->lookups & 1023) == 0;
+            double t0 = timed ? now_ns() : 0.0;
+            bench_fn fn = (bench_fn)hr_get_fn(g_mod, g_names[i]);
+            if (timed) {
+                double dt = now_ns() - t0;
+                if (dt > w->worst_ns) w->worst_ns = dt;
+            }
+            w->lookups++;
+            if (!fn) { w->errors++; continue; }
+            int r = fn(x) - x - i;
+            if (r < 0 || r % 1000 != 0) w->errors++;
+        }
+        x++;
+        hr_quiescent();
+    }
+    hr_thread_unregister();
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID arg) { run_worker((worker_t*)arg); return 0; }
+#else
+static void* worker_main(void* arg) { run_worker((worker_t*)arg); return NULL; }
+#endif
+
+static unsigned long long total_lookups(int threads) {
+    unsigned long long n = 0;
+    for (int t = 0; t < threads; t++) n += g_workers[t].lookups;
+    return n;
+}
+
+static void reset_worst(int threads) {
+    for (int t = 0; t < threads; t++) g_workers[t].worst_ns = 0.0;
+}
+
+static double worst(int threads) {
+    double w = 0.0;
+    for (int t = 0; t < threads; t++)
+        if (g_workers[t].worst_ns > w) w = g_workers[t].worst_ns;
+    return w;
+}
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? atoi(argv[1]) : 32;
+    int seconds = argc > 2 ? atoi(argv[2]) : 3;
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (seconds < 1) seconds = 1;
+
+    hr_config_t cfg = hr_default_config();
+    cfg.log_level     = HR_LOG_ERROR;
+    cfg.build_dir     = BUILD_DIR;
+    cfg.async_compile = 0;
+
+    hr_context_t* ctx = hr_init(".", HR_LANG_C, &cfg);
+    if (!ctx) { fprintf(stderr, "hr_init failed\n"); return 1; }
+    if (!write_module(0)) { fprintf(stderr, "cannot write %s\n", MODULE_SRC); return 1; }
+    g_mod = hr_load(ctx, MODULE_SRC);
+    if (!g_mod) { fprintf(stderr, "hr_load failed\n"); hr_shutdown(ctx); return 1; }
+    for (int i = 0; i < FN_COUNT; i++)
+        snprintf(g_names[i], sizeof(g_names[i]), "bench_fn_%02d", i);
+
+#ifdef _WIN32
+    HANDLE handles[MAX_THREADS];
+    for (int t = 0; t < threads; t++)
+        handles[t] = CreateThread(NULL, 0, worker_main, &g_workers[t], 0, NULL);
+#else
+    pthread_t handles[MAX_THREADS];
+    for (int t = 0; t < threads; t++)
+        pthread_create(&handles[t], NULL, worker_main, &g_workers[t]);
+#endif
+
+    /* Steady state first, then the same load while the main thread
+       rebuilds and swaps the module back to back. */
+    unsigned long long l0 = total_lookups(threads);
+    double t0 = now_ns();
+    sleep_ms(seconds * 500);
+    unsigned long long l1 = total_lookups(threads);
+    double t1 = now_ns();
+    double steady_worst = worst(threads);
+    reset_worst(threads);
+
+    int reloads = 0, failed = 0;
+    while (now_ns() - t1 < (double)seconds * 1e9) {
+        write_module(reloads + 1);
+        if (hr_reload_module(ctx, g_mod) == HR_OK) reloads++;
+        else                                       failed++;
+        hr_quiescent();
+    }
+    unsigned long long l2 = total_lookups(threads);
+    double t2 = now_ns();
+    double reload_worst = worst(threads);
+
+    g_stop = 1;
+#ifdef _WIN32
+    for (int t = 0; t < threads; t++) { WaitForSingleObject(handles[t], INFINITE); CloseHandle(handles[t]); }
+#else
+    for (int t = 0; t < threads; t++) pthread_join(handles[t], NULL);
+#endif
+
+    unsigned long long errors = 0;
+    for (int t = 0; t < threads; t++) errors += g_workers[t].errors;
+    hr_stats_t st;
+    hr_get_stats(ctx, &st);
+
+    printf("threads        : %d\n", threads);
+    printf("functions      : %d\n", FN_COUNT);
+    printf("steady         : %8.2f M lookups/s | worst sampled %.1f us\n",
+           (double)(l1 - l0) / ((t1 - t0) / 1e9) / 1e6, steady_worst / 1e3);
+    printf("during reloads : %8.2f M lookups/s | worst sampled %.1f us\n",
+           (double)(l2 - l1) / ((t2 - t1) / 1e9) / 1e6, reload_worst / 1e3);
+    printf("reloads        : %d ok, %d failed\n", reloads, failed);
+    printf("generations    : %llu reclaimed, %llu pending\n",
+           (unsigned long long)st.generations_reclaimed, (unsigned long long)st.generations_pending);
+    printf("bad lookups    : %llu\n", errors);
+
+    hr_shutdown(ctx);
+    return errors == 0 && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "hotreload.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define FN_COUNT   40
+#define FRAMES     200000
+#define BUILD_DIR  ".hotreload_bench"
+#define MODULE_SRC BUILD_DIR "/bench_module.c"
+
+typedef int (*bench_fn)(int);
+
+static double now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart * 1e9 / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+static int write_module(int bias) {
+    FILE* f = fopen(MODULE_SRC, "w");
+    if (!f) return 0;
+    for (int i = 0; i < FN_COUNT; i++)
+        fprintf(f, "int bench_fn_%02d(int x) { return x + %d; }\n", i, i + bias);
+    fclose(f);
+    return 1;
+}
+
+int main(void) {
+    hr_config_t cfg = hr_default_config();
+    cfg.log_level   = HR_LOG_ERROR;
+    cfg.build_dir   = BUILD_DIR;
+
+    hr_context_t* ctx = hr_init(".", HR_LANG_C, &cfg);
+    if (!ctx) { fprintf(stderr, "hr_init failed\n"); return 1; }
+
+    if (!write_module(0)) { fprintf(stderr, "cannot write %s\n", MODULE_SRC); return 1; }
+    hr_module_t* mod = hr_load(ctx, MODULE_SRC);
+    if (!mod) { fprintf(stderr, "hr_load failed\n"); hr_shutdown(ctx); return 1; }
+
+    char names[FN_COUNT][32];
+    hr_fn_slot_t* slots[FN_COUNT];
+    for (int i = 0; i < FN_COUNT; i++) {
+        snprintf(names[i], sizeof(names[i]), "bench_fn_%02d", i);
+        slots[i] = hr_bind(mod, names[i]);
+        if (!slots[i] || !hr_slot_fn(slots[i])) {
+            fprintf(stderr, "cannot bind %s\n", names[i]);
+            return 1;
+        }
+    }
+
+    volatile int sink = 0;
+    double t0 = now_ns();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int i = 0; i < FN_COUNT; i++) {
+            bench_fn fn = (bench_fn)hr_get_fn(mod, names[i]);
+            sink += fn(frame);
+        }
+    }
+    double t1 = now_ns();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int i = 0; i < FN_COUNT; i++) {
+            bench_fn fn = (bench_fn)hr_slot_fn(slots[i]);
+            sink += fn(frame);
+        }
+    }
+    double t2 = now_ns();
+
+    double calls = (double)FRAMES * FN_COUNT;
+    printf("functions      : %d\n", FN_COUNT);
+    printf("frames         : %d\n", FRAMES);
+    printf("hr_get_fn      : %8.2f ns/call\n", (t1 - t0) / calls);
+    printf("hr_bind slot   : %8.2f ns/call\n", (t2 - t1) / calls);
+
+    write_module(1000);
+    if (hr_reload_module(ctx, mod) != HR_OK) { fprintf(stderr, "reload failed\n"); return 1; }
+    int after = ((bench_fn)hr_slot_fn(slots[7]))(0);
+    printf("slot after reload: bench_fn_07(0) = %d (%s)\n", after, after == 1007 ? "OK" : "STALE");
+
+    hr_shutdown(ctx);
+    return after == 1007 ? 0 : 1;
+}
@@ -64,19 +64,99 @@ typedef struct {
     hr_on_reload_fn     on_reload;
     int                 poll_interval_ms;
     int                 enable_patching;
+    int                 async_compile;
+    int                 max_jobs;
+    int                 event_queue_size;
+    int                 debounce_ms;
+    int                 watch_recursive;
+    const char*         watch_filter;
+    int                 enable_cache;
+    uint64_t            cache_max_bytes;
+    int                 enable_pch;
+    const char*         linker;
+    const char*         patch_strategy;
+    int                 max_generations;
 } hr_config_t;
 
+typedef struct {
+    uint64_t events_received;
+    uint64_t events_coalesced;
+    uint64_t events_dropped;
+    uint64_t events_filtered;
+    int      watch_directories;
+    size_t   watch_memory_bytes;
+    uint64_t watch_startup_us;
+    uint64_t reloads_ok;
+    uint64_t reloads_failed;
+    uint64_t reloads_skipped;
+    uint64_t reloads_unchanged;
+    uint64_t builds_cancelled;
+    uint64_t compiles;
+    uint64_t compile_wall_us;
+    uint64_t compile_cpu_us;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t cache_evictions;
+    uint64_t cache_shared;
+    uint64_t cache_bytes;
+    uint64_t pch_hits;
+    uint64_t pch_misses;
+    uint64_t pch_failures;
+    uint64_t object_hits;
+    uint64_t object_misses;
+    uint64_t functions_patched;
+    uint64_t functions_changed;
+    uint64_t functions_via_got;
+    uint64_t got_slots_patched;
+    uint64_t patch_pause_ns;
+    uint64_t patch_pause_max_ns;
+    uint64_t patch_ns;
+    uint64_t patch_protect_calls;
+    uint64_t generations_retained;
+    uint64_t generations_pending;
+    uint64_t generations_reclaimed;
+} hr_stats_t;
+
+typedef struct {
+    hr_lang_t lang;
+    int       available;
+    char      compiler[64];
+    char      version[160];
+    char      linker[16];
+} hr_toolchain_t;
+
 typedef struct hr_context hr_context_t;
 typedef struct hr_module  hr_module_t;
 
+typedef struct {
+    void*       fn;
+    const char* name;
+} hr_fn_slot_t;
+
+static inline void* hr_slot_fn(const hr_fn_slot_t* slot) {
+#if defined(_MSC_VER)
+    return *(void* const volatile*)&slot->fn;
+#else
+    return __atomic_load_n(&slot->fn, __ATOMIC_ACQUIRE);
+#endif
+}
+
 HR_API hr_config_t    hr_default_config(void);
 HR_API hr_context_t*  hr_init(const char* watch_dir, hr_lang_t lang, const hr_config_t* config);
 HR_API void           hr_shutdown(hr_context_t* ctx);
 HR_API hr_module_t*   hr_load(hr_context_t* ctx, const char* source_path);
+HR_API hr_module_t*   hr_load_sources(hr_context_t* ctx, const char* name,
+                                      const char* const* sources, int count);
 HR_API void           hr_unload(hr_context_t* ctx, hr_module_t* mod);
 HR_API hr_result_t    hr_poll(hr_context_t* ctx);
+HR_API int            hr_thread_register(void);
+HR_API void           hr_thread_unregister(void);
+HR_API void           hr_quiescent(void);
 HR_API void*          hr_get_fn(hr_module_t* mod, const char* name);
+HR_API hr_fn_slot_t*  hr_bind(hr_module_t* mod, const char* name);
 HR_API hr_result_t    hr_reload_module(hr_context_t* ctx, hr_module_t* mod);
+HR_API void           hr_get_stats(hr_context_t* ctx, hr_stats_t* out);
+HR_API hr_result_t    hr_get_toolchain(hr_context_t* ctx, hr_lang_t lang, hr_toolchain_t* out);
 HR_API const char*    hr_result_str(hr_result_t result);
 HR_API const char*    hr_version(void);
 
@@ -2,17 +2,36 @@
 #define HR_ADAPTER_H
 
 #include "../../include/hotreload.h"
+#include "../platform/hr_platform.h"
 #include <stddef.h>
 
-typedef struct {
+/* The registered adapters are shared, read-only templates. Each context
+   works on its own copy (see hr_toolchain_apply), which the build hooks
+   receive as `self` to find the compiler and linker to run. */
+typedef struct hr_adapter hr_adapter_t;
+
+struct hr_adapter {
     hr_lang_t lang;
     const char* name;
     const char* source_ext;
+    const char* compiler;
+    const char* const* compilers;
+    const char* version_arg;
+    int system_linker;
+    const char* linker_flag;
+    int emits_depfile;
     int (*detect)(const char* source_path);
-    int (*compile)(const char* source_path, const char* output_path, const char* extra_flags);
-    int (*list_symbols)(const char* lib_path, char* out_buf, size_t buf_size);
+    int (*compile)(const hr_adapter_t* self, const char* source_path, const char* output_path,
+                   const char* extra_flags, hr_process_result_t* result);
+    int (*compile_object)(const hr_adapter_t* self, const char* source_path, const char* object_path,
+                          const char* extra_flags, hr_process_result_t* result);
+    int (*link)(const hr_adapter_t* self, const char* const* objects, int count,
+                const char* output_path, const char* extra_flags, hr_process_result_t* result);
+    int (*compile_pch)(const hr_adapter_t* self, const char* header_path, const char* output_path,
+                       const char* extra_flags, hr_process_result_t* result);
+    char* (*list_symbols)(const char* lib_path);
     char* (*demangle)(const char* mangled);
-} hr_adapter_t;
+};
 
 hr_adapter_t* hr_adapter_get(hr_lang_t lang);
 hr_adapter_t* hr_adapter_detect(const char* source_path);
@@ -1,5 +1,5 @@
 #include "hr_adapter.h"
-#include "../platform/hr_platform.h"
+#include "hr_cmd.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,36 +9,71 @@ static int c_detect(const char* path) {
     return ext && strcmp(ext, ".c") == 0;
 }
 
-static int c_compile(const char* src, const char* out, const char* flags) {
-    char cmd[8192];
-    const char* compiler = "gcc";
-    snprintf(cmd, sizeof(cmd),
-        "%s -shared -fPIC -O0 -fno-inline -g %s \"%s\" -o \"%s\" 2>&1",
-        compiler, flags ? flags : "", src, out);
-    char errbuf[4096] = {0};
-    int ret = hr_platform_run_command(cmd, errbuf, sizeof(errbuf));
-    if (ret != 0) {
-        fprintf(stderr, "[hr:c] compile error:\n%s\n", errbuf);
-    }
-    return ret == 0;
+static int c_compile(const hr_adapter_t* self, const char* src, const char* out,
+                     const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "-shared", "-fPIC", "-O0", "-fno-inline", "-g", "-MMD", "-MF", NULL);
+    hr_cmd_argf(&cmd, "%s.d", out);
+    if (self->linker_flag) hr_cmd_arg(&cmd, self->linker_flag);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, src, "-o", out, NULL);
+    return hr_cmd_compile(&cmd, "c", result);
 }
 
-static int c_list_symbols(const char* lib, char* out, size_t sz) {
-    char cmd[4096];
-    snprintf(cmd, sizeof(cmd), "nm -D --defined-only \"%s\" 2>&1", lib);
-    return hr_platform_run_command(cmd, out, sz) == 0;
+static int c_compile_object(const hr_adapter_t* self, const char* src, const char* obj,
+                            const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "-c", "-fPIC", "-O0", "-fno-inline", "-g", "-MMD", "-MF", NULL);
+    hr_cmd_argf(&cmd, "%s.d", obj);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, src, "-o", obj, NULL);
+    return hr_cmd_compile(&cmd, "c", result);
+}
+
+static int c_link(const hr_adapter_t* self, const char* const* objects, int count,
+                  const char* out, const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_arg(&cmd, "-shared");
+    if (self->linker_flag) hr_cmd_arg(&cmd, self->linker_flag);
+    for (int i = 0; i < count; i++) hr_cmd_arg(&cmd, objects[i]);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, "-o", out, NULL);
+    return hr_cmd_compile(&cmd, "c", result);
+}
+
+static int c_compile_pch(const hr_adapter_t* self, const char* header, const char* out,
+                         const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "-x", "c-header", "-fPIC", "-O0", "-fno-inline", "-g", "-MMD", "-MF", NULL);
+    hr_cmd_argf(&cmd, "%s.d", out);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, header, "-o", out, NULL);
+    return hr_cmd_compile(&cmd, "c", result);
 }
 
 static char* c_demangle(const char* name) {
     return strdup(name);
 }
 
+static const char* const c_compilers[] = { "gcc", "clang", "cc", NULL };
+
 hr_adapter_t hr_adapter_c = {
-    .lang         = HR_LANG_C,
-    .name         = "C",
-    .source_ext   = ".c",
-    .detect       = c_detect,
-    .compile      = c_compile,
-    .list_symbols = c_list_symbols,
-    .demangle     = c_demangle,
+    .lang           = HR_LANG_C,
+    .name           = "C",
+    .source_ext     = ".c",
+    .compiler       = "gcc",
+    .compilers      = c_compilers,
+    .system_linker  = 1,
+    .emits_depfile  = 1,
+    .detect         = c_detect,
+    .compile        = c_compile,
+    .compile_object = c_compile_object,
+    .link           = c_link,
+    .compile_pch    = c_compile_pch,
+    .list_symbols   = hr_cmd_list_symbols,
+    .demangle       = c_demangle,
 };
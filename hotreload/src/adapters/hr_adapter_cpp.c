@@ -1,5 +1,6 @@
 #include "hr_adapter.h"
-#include "../platform/hr_platform.h"
+#include "hr_demangle.h"
+#include "hr_cmd.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,39 +10,72 @@ static int cpp_detect(const char* path) {
     return ext && (strcmp(ext, ".cpp") == 0 || strcmp(ext, ".cc") == 0 || strcmp(ext, ".cxx") == 0);
 }
 
-static int cpp_compile(const char* src, const char* out, const char* flags) {
-    char cmd[8192];
-    snprintf(cmd, sizeof(cmd),
-        "g++ -shared -fPIC -O0 -fno-inline -g %s \"%s\" -o \"%s\" 2>&1",
-        flags ? flags : "", src, out);
-    char errbuf[4096] = {0};
-    int ret = hr_platform_run_command(cmd, errbuf, sizeof(errbuf));
-    if (ret != 0) fprintf(stderr, "[hr:cpp] compile error:\n%s\n", errbuf);
-    return ret == 0;
+static int cpp_compile(const hr_adapter_t* self, const char* src, const char* out,
+                       const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "-shared", "-fPIC", "-O0", "-fno-inline", "-g", "-MMD", "-MF", NULL);
+    hr_cmd_argf(&cmd, "%s.d", out);
+    if (self->linker_flag) hr_cmd_arg(&cmd, self->linker_flag);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, src, "-o", out, NULL);
+    return hr_cmd_compile(&cmd, "cpp", result);
 }
 
-static int cpp_list_symbols(const char* lib, char* out, size_t sz) {
-    char cmd[4096];
-    snprintf(cmd, sizeof(cmd), "nm -D --defined-only \"%s\" 2>&1", lib);
-    return hr_platform_run_command(cmd, out, sz) == 0;
+static int cpp_compile_object(const hr_adapter_t* self, const char* src, const char* obj,
+                              const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "-c", "-fPIC", "-O0", "-fno-inline", "-g", "-MMD", "-MF", NULL);
+    hr_cmd_argf(&cmd, "%s.d", obj);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, src, "-o", obj, NULL);
+    return hr_cmd_compile(&cmd, "cpp", result);
+}
+
+static int cpp_link(const hr_adapter_t* self, const char* const* objects, int count,
+                    const char* out, const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_arg(&cmd, "-shared");
+    if (self->linker_flag) hr_cmd_arg(&cmd, self->linker_flag);
+    for (int i = 0; i < count; i++) hr_cmd_arg(&cmd, objects[i]);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, "-o", out, NULL);
+    return hr_cmd_compile(&cmd, "cpp", result);
+}
+
+static int cpp_compile_pch(const hr_adapter_t* self, const char* header, const char* out,
+                           const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "-x", "c++-header", "-fPIC", "-O0", "-fno-inline", "-g", "-MMD", "-MF", NULL);
+    hr_cmd_argf(&cmd, "%s.d", out);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, header, "-o", out, NULL);
+    return hr_cmd_compile(&cmd, "cpp", result);
 }
 
 static char* cpp_demangle(const char* name) {
-    char cmd[2048];
-    snprintf(cmd, sizeof(cmd), "echo '%s' | c++filt 2>/dev/null", name);
-    char out[1024] = {0};
-    hr_platform_run_command(cmd, out, sizeof(out));
-    size_t len = strlen(out);
-    while (len > 0 && (out[len-1] == '\n' || out[len-1] == '\r')) out[--len] = 0;
-    return strdup(len > 0 ? out : name);
+    char* out = hr_demangle_itanium(name);
+    return out ? out : strdup(name);
 }
 
+static const char* const cpp_compilers[] = { "g++", "clang++", "c++", NULL };
+
 hr_adapter_t hr_adapter_cpp = {
-    .lang         = HR_LANG_CPP,
-    .name         = "C++",
-    .source_ext   = ".cpp",
-    .detect       = cpp_detect,
-    .compile      = cpp_compile,
-    .list_symbols = cpp_list_symbols,
-    .demangle     = cpp_demangle,
+    .lang           = HR_LANG_CPP,
+    .name           = "C++",
+    .source_ext     = ".cpp",
+    .compiler       = "g++",
+    .compilers      = cpp_compilers,
+    .system_linker  = 1,
+    .emits_depfile  = 1,
+    .detect         = cpp_detect,
+    .compile        = cpp_compile,
+    .compile_object = cpp_compile_object,
+    .link           = cpp_link,
+    .compile_pch    = cpp_compile_pch,
+    .list_symbols   = hr_cmd_list_symbols,
+    .demangle       = cpp_demangle,
 };
@@ -1,5 +1,5 @@
 #include "hr_adapter.h"
-#include "../platform/hr_platform.h"
+#include "hr_cmd.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,33 +9,34 @@ static int go_detect(const char* path) {
     return ext && strcmp(ext, ".go") == 0;
 }
 
-static int go_compile(const char* src, const char* out, const char* flags) {
-    char cmd[8192];
-    snprintf(cmd, sizeof(cmd),
-        "go build -buildmode=c-shared %s -o \"%s\" \"%s\" 2>&1",
-        flags ? flags : "", out, src);
-    char errbuf[4096] = {0};
-    int ret = hr_platform_run_command(cmd, errbuf, sizeof(errbuf));
-    if (ret != 0) fprintf(stderr, "[hr:go] compile error:\n%s\n", errbuf);
-    return ret == 0;
-}
-
-static int go_list_symbols(const char* lib, char* out, size_t sz) {
-    char cmd[4096];
-    snprintf(cmd, sizeof(cmd), "nm -D --defined-only \"%s\" 2>&1", lib);
-    return hr_platform_run_command(cmd, out, sz) == 0;
+static int go_compile(const hr_adapter_t* self, const char* src, const char* out,
+                      const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "build", "-buildmode=c-shared", NULL);
+    if (self->linker_flag)
+        hr_cmd_argf(&cmd, "-ldflags=-extldflags=%s", self->linker_flag);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_args(&cmd, "-o", out, src, NULL);
+    return hr_cmd_compile(&cmd, "go", result);
 }
 
 static char* go_demangle(const char* name) {
     return strdup(name);
 }
 
+static const char* const go_compilers[] = { "go", NULL };
+
 hr_adapter_t hr_adapter_go = {
-    .lang         = HR_LANG_GO,
-    .name         = "Go",
-    .source_ext   = ".go",
-    .detect       = go_detect,
-    .compile      = go_compile,
-    .list_symbols = go_list_symbols,
-    .demangle     = go_demangle,
+    .lang          = HR_LANG_GO,
+    .name          = "Go",
+    .source_ext    = ".go",
+    .compiler      = "go",
+    .compilers     = go_compilers,
+    .version_arg   = "version",
+    .system_linker = 1,
+    .detect        = go_detect,
+    .compile       = go_compile,
+    .list_symbols  = hr_cmd_list_symbols,
+    .demangle      = go_demangle,
 };
@@ -1,5 +1,5 @@
 #include "hr_adapter.h"
-#include "../platform/hr_platform.h"
+#include "hr_cmd.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,33 +9,32 @@ static int zig_detect(const char* path) {
     return ext && strcmp(ext, ".zig") == 0;
 }
 
-static int zig_compile(const char* src, const char* out, const char* flags) {
-    char cmd[8192];
-    snprintf(cmd, sizeof(cmd),
-        "zig build-lib -dynamic -O Debug %s \"%s\" --name hr_module 2>&1 && mv libhr_module%s \"%s\"",
-        flags ? flags : "", src, hr_platform_lib_ext(), out);
-    char errbuf[4096] = {0};
-    int ret = hr_platform_run_command(cmd, errbuf, sizeof(errbuf));
-    if (ret != 0) fprintf(stderr, "[hr:zig] compile error:\n%s\n", errbuf);
-    return ret == 0;
-}
-
-static int zig_list_symbols(const char* lib, char* out, size_t sz) {
-    char cmd[4096];
-    snprintf(cmd, sizeof(cmd), "nm -D --defined-only \"%s\" 2>&1", lib);
-    return hr_platform_run_command(cmd, out, sz) == 0;
+static int zig_compile(const hr_adapter_t* self, const char* src, const char* out,
+                       const char* flags, hr_process_result_t* result) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, self->compiler);
+    hr_cmd_args(&cmd, "build-lib", "-dynamic", "-O", "Debug", NULL);
+    hr_cmd_flags(&cmd, flags);
+    hr_cmd_arg(&cmd, src);
+    hr_cmd_argf(&cmd, "-femit-bin=%s", out);
+    return hr_cmd_compile(&cmd, "zig", result);
 }
 
 static char* zig_demangle(const char* name) {
     return strdup(name);
 }
 
+static const char* const zig_compilers[] = { "zig", NULL };
+
 hr_adapter_t hr_adapter_zig = {
     .lang         = HR_LANG_ZIG,
     .name         = "Zig",
     .source_ext   = ".zig",
+    .compiler     = "zig",
+    .compilers    = zig_compilers,
+    .version_arg  = "version",
     .detect       = zig_detect,
     .compile      = zig_compile,
-    .list_symbols = zig_list_symbols,
+    .list_symbols = hr_cmd_list_symbols,
     .demangle     = zig_demangle,
 };
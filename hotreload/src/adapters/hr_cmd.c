@@ -0,0 +1,120 @@
+#include "hr_cmd.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void push(hr_cmd_t* cmd, char* arg) {
+    if (!arg) { cmd->error = 1; return; }
+    if (cmd->count + 2 > cmd->capacity) {
+        int cap = cmd->capacity ? cmd->capacity * 2 : 16;
+        char** argv = realloc(cmd->argv, sizeof(char*) * (size_t)cap);
+        if (!argv) { free(arg); cmd->error = 1; return; }
+        cmd->argv     = argv;
+        cmd->capacity = cap;
+    }
+    cmd->argv[cmd->count++] = arg;
+    cmd->argv[cmd->count]   = NULL;
+}
+
+void hr_cmd_init(hr_cmd_t* cmd, const char* program) {
+    memset(cmd, 0, sizeof(*cmd));
+    hr_cmd_arg(cmd, program);
+}
+
+void hr_cmd_free(hr_cmd_t* cmd) {
+    for (int i = 0; i < cmd->count; i++) free(cmd->argv[i]);
+    free(cmd->argv);
+    memset(cmd, 0, sizeof(*cmd));
+}
+
+void hr_cmd_arg(hr_cmd_t* cmd, const char* arg) {
+    push(cmd, strdup(arg));
+}
+
+void hr_cmd_argf(hr_cmd_t* cmd, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+    char* arg = len >= 0 ? malloc((size_t)len + 1) : NULL;
+    if (arg) {
+        va_start(ap, fmt);
+        vsnprintf(arg, (size_t)len + 1, fmt, ap);
+        va_end(ap);
+    }
+    push(cmd, arg);
+}
+
+void hr_cmd_args(hr_cmd_t* cmd, ...) {
+    va_list ap;
+    va_start(ap, cmd);
+    for (const char* arg = va_arg(ap, const char*); arg; arg = va_arg(ap, const char*))
+        hr_cmd_arg(cmd, arg);
+    va_end(ap);
+}
+
+void hr_cmd_flags(hr_cmd_t* cmd, const char* flags) {
+    if (!flags) return;
+    const char* p = flags;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\n') p++;
+        if (!*p) break;
+        char* arg = malloc(strlen(p) + 1);
+        if (!arg) { cmd->error = 1; return; }
+        size_t n = 0;
+        char quote = 0;
+        for (; *p; p++) {
+            if (quote) {
+                if (*p == quote) quote = 0;
+                else if (*p == '\\' && quote == '"' && (p[1] == '"' || p[1] == '\\')) arg[n++] = *++p;
+                else arg[n++] = *p;
+            } else if (*p == '\'' || *p == '"') {
+                quote = *p;
+            } else if (*p == '\\' && p[1]) {
+                arg[n++] = *++p;
+            } else if (*p == ' ' || *p == '\t' || *p == '\n') {
+                break;
+            } else {
+                arg[n++] = *p;
+            }
+        }
+        arg[n] = 0;
+        push(cmd, arg);
+    }
+}
+
+int hr_cmd_run(hr_cmd_t* cmd, hr_process_result_t* result) {
+    int status = -1;
+    memset(result, 0, sizeof(*result));
+    result->status = -1;
+    if (!cmd->error && cmd->count > 0)
+        status = hr_platform_spawn((const char* const*)cmd->argv, result);
+    hr_cmd_free(cmd);
+    return status;
+}
+
+int hr_cmd_compile(hr_cmd_t* cmd, const char* tag, hr_process_result_t* result) {
+    hr_process_result_t local;
+    if (!result) result = &local;
+    int status = hr_cmd_run(cmd, result);
+    if (status != 0 && status != HR_PLATFORM_CANCELLED && (result->err_len || result->out_len)) {
+        fprintf(stderr, "[hr:%s] compile error:\n%s%s\n", tag,
+                result->err ? result->err : "", result->out ? result->out : "");
+    }
+    if (result == &local) hr_platform_process_result_free(&local);
+    return status == 0;
+}
+
+char* hr_cmd_list_symbols(const char* lib_path) {
+    hr_cmd_t cmd;
+    hr_cmd_init(&cmd, "nm");
+    hr_cmd_args(&cmd, "-D", "--defined-only", lib_path, NULL);
+    hr_process_result_t result;
+    if (hr_cmd_run(&cmd, &result) != 0) {
+        hr_platform_process_result_free(&result);
+        return NULL;
+    }
+    free(result.err);
+    return result.out;
+}
@@ -0,0 +1,23 @@
+#ifndef HR_CMD_H
+#define HR_CMD_H
+
+#include "../platform/hr_platform.h"
+
+typedef struct {
+    char** argv;
+    int    count;
+    int    capacity;
+    int    error;
+} hr_cmd_t;
+
+void  hr_cmd_init(hr_cmd_t* cmd, const char* program);
+void  hr_cmd_free(hr_cmd_t* cmd);
+void  hr_cmd_arg(hr_cmd_t* cmd, const char* arg);
+void  hr_cmd_argf(hr_cmd_t* cmd, const char* fmt, ...);
+void  hr_cmd_args(hr_cmd_t* cmd, ...);
+void  hr_cmd_flags(hr_cmd_t* cmd, const char* flags);
+int   hr_cmd_run(hr_cmd_t* cmd, hr_process_result_t* result);
+int   hr_cmd_compile(hr_cmd_t* cmd, const char* tag, hr_process_result_t* result);
+char* hr_cmd_list_symbols(const char* lib_path);
+
+#endif
@@ -0,0 +1,841 @@
+#include "hr_demangle.h"
+#include "../platform/hr_platform.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HR_DEMANGLE_MAX_DEPTH 256
+#define HR_PUNYCODE_MAX       256
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define load_long(p)     (*(volatile long*)(p))
+#define store_long(p, v) (*(volatile long*)(p) = (v))
+#define cas_long(p, expected, desired) \
+    (_InterlockedCompareExchange((p), (desired), (expected)) == (expected))
+#else
+#define load_long(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define store_long(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define cas_long(p, expected, desired) \
+    __atomic_compare_exchange_n((p), &(long){expected}, (desired), 0, \
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif
+
+typedef struct {
+    char*  data;
+    size_t len;
+    size_t cap;
+    int    error;
+} hr_strbuf_t;
+
+static void sb_putn(hr_strbuf_t* sb, const char* s, size_t n) {
+    if (!sb || sb->error) return;
+    if (sb->len + n + 1 > sb->cap) {
+        size_t cap = sb->cap ? sb->cap : 64;
+        while (cap < sb->len + n + 1) cap *= 2;
+        char* data = realloc(sb->data, cap);
+        if (!data) { sb->error = 1; return; }
+        sb->data = data;
+        sb->cap  = cap;
+    }
+    memcpy(sb->data + sb->len, s, n);
+    sb->len += n;
+    sb->data[sb->len] = 0;
+}
+
+static void sb_puts(hr_strbuf_t* sb, const char* s) { sb_putn(sb, s, strlen(s)); }
+static void sb_putc(hr_strbuf_t* sb, char c)        { sb_putn(sb, &c, 1); }
+
+static void sb_put_u64(hr_strbuf_t* sb, uint64_t v) {
+    char buf[24];
+    int  i = (int)sizeof(buf);
+    do { buf[--i] = (char)('0' + v % 10); v /= 10; } while (v);
+    sb_putn(sb, buf + i, sizeof(buf) - (size_t)i);
+}
+
+static void sb_put_utf8(hr_strbuf_t* sb, uint32_t cp) {
+    char b[4];
+    if (cp < 0x80) { b[0] = (char)cp; sb_putn(sb, b, 1); }
+    else if (cp < 0x800) {
+        b[0] = (char)(0xC0 | (cp >> 6));
+        b[1] = (char)(0x80 | (cp & 0x3F));
+        sb_putn(sb, b, 2);
+    } else if (cp < 0x10000) {
+        b[0] = (char)(0xE0 | (cp >> 12));
+        b[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        b[2] = (char)(0x80 | (cp & 0x3F));
+        sb_putn(sb, b, 3);
+    } else {
+        b[0] = (char)(0xF0 | (cp >> 18));
+        b[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        b[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        b[3] = (char)(0x80 | (cp & 0x3F));
+        sb_putn(sb, b, 4);
+    }
+}
+
+static char* sb_finish(hr_strbuf_t* sb, int ok) {
+    if (ok && !sb->error && sb->data) return sb->data;
+    free(sb->data);
+    return NULL;
+}
+
+/* Itanium C++ ABI: use the runtime's own demangler, resolved lazily so the
+   library itself stays free of a C++ runtime dependency. */
+
+typedef char* (*hr_cxa_demangle_fn)(const char*, char*, size_t*, int*);
+
+/* Demangled indexes of different modules may be built at once: one thread
+   resolves (state 1) while the others wait, and fn is published by the
+   release store of state 2. */
+static volatile long      cxa_state;
+static hr_cxa_demangle_fn cxa_demangle;
+
+static hr_cxa_demangle_fn resolve_cxa_demangle(void) {
+    static const char* runtimes[] = {
+        "libstdc++.so.6", "libc++abi.so.1", "libc++.so.1",
+        "libc++abi.dylib", "libstdc++.6.dylib", NULL
+    };
+    while (load_long(&cxa_state) != 2) {
+        if (!cas_long(&cxa_state, 0, 1)) {
+            hr_platform_sleep_ms(1);
+            continue;
+        }
+        hr_cxa_demangle_fn fn = NULL;
+        for (int i = 0; runtimes[i] && !fn; i++) {
+            void* lib = hr_platform_lib_open(runtimes[i]);
+            if (!lib) continue;
+            fn = (hr_cxa_demangle_fn)hr_platform_lib_sym(lib, "__cxa_demangle");
+            if (!fn) hr_platform_lib_close(lib);
+        }
+        cxa_demangle = fn;
+        store_long(&cxa_state, 2);
+    }
+    return cxa_demangle;
+}
+
+char* hr_demangle_itanium(const char* mangled) {
+    const char* s = mangled;
+    if (strncmp(s, "__Z", 3) == 0) s++;
+    if (strncmp(s, "_Z", 2) != 0) return NULL;
+    hr_cxa_demangle_fn fn = resolve_cxa_demangle();
+    if (!fn) return NULL;
+    int status = 0;
+    char* out = fn(s, NULL, NULL, &status);
+    if (status != 0) { free(out); return NULL; }
+    return out;
+}
+
+/* Rust legacy mangling: _ZN <len><ident>... 17h<16 hex> E */
+
+static int is_rust_hash(const char* s, size_t len) {
+    if (len != 17 || s[0] != 'h') return 0;
+    for (size_t i = 1; i < len; i++) {
+        char c = s[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return 0;
+    }
+    return 1;
+}
+
+static int legacy_escape(const char* esc, size_t len, hr_strbuf_t* out) {
+    static const struct { const char* code; const char* text; } table[] = {
+        {"SP", "@"}, {"BP", "*"}, {"RF", "&"}, {"LT", "<"}, {"GT", ">"},
+        {"LP", "("}, {"RP", ")"}, {"C", ","}, {NULL, NULL}
+    };
+    for (int i = 0; table[i].code; i++) {
+        if (strlen(table[i].code) == len && memcmp(table[i].code, esc, len) == 0) {
+            sb_puts(out, table[i].text);
+            return 1;
+        }
+    }
+    if (len < 2 || esc[0] != 'u') return 0;
+    uint32_t cp = 0;
+    for (size_t i = 1; i < len; i++) {
+        char c = esc[i];
+        int  d;
+        if      (c >= '0' && c <= '9') d = c - '0';
+        else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+        else return 0;
+        cp = (cp << 4) | (uint32_t)d;
+        if (cp > 0x10FFFF) return 0;
+    }
+    sb_put_utf8(out, cp);
+    return 1;
+}
+
+static int legacy_ident(const char* s, size_t len, hr_strbuf_t* out) {
+    const char* end = s + len;
+    if (len >= 2 && s[0] == '_' && s[1] == '$') s++;
+    while (s < end) {
+        if (*s == '.') {
+            if (s + 1 < end && s[1] == '.') { sb_puts(out, "::"); s += 2; }
+            else                            { sb_putc(out, '.');  s += 1; }
+        } else if (*s == '$') {
+            const char* close = memchr(s + 1, '$', (size_t)(end - s - 1));
+            if (!close || !legacy_escape(s + 1, (size_t)(close - s - 1), out)) return 0;
+            s = close + 1;
+        } else {
+            const char* run = s;
+            while (s < end && *s != '$' && *s != '.') s++;
+            sb_putn(out, run, (size_t)(s - run));
+        }
+    }
+    return 1;
+}
+
+static char* demangle_legacy(const char* s) {
+    if      (strncmp(s, "__ZN", 4) == 0) s += 4;
+    else if (strncmp(s, "_ZN", 3) == 0)  s += 3;
+    else if (strncmp(s, "ZN", 2) == 0)   s += 2;
+    else return NULL;
+
+    const char* parts[HR_DEMANGLE_MAX_DEPTH];
+    size_t      lens[HR_DEMANGLE_MAX_DEPTH];
+    int         count = 0;
+    while (*s != 'E') {
+        if (*s < '0' || *s > '9' || count >= HR_DEMANGLE_MAX_DEPTH) return NULL;
+        size_t len = 0;
+        while (*s >= '0' && *s <= '9') {
+            len = len * 10 + (size_t)(*s++ - '0');
+            if (len > 4096) return NULL;
+        }
+        if (strnlen(s, len) < len) return NULL;
+        parts[count] = s;
+        lens[count]  = len;
+        count++;
+        s += len;
+    }
+    if (count < 2 || !is_rust_hash(parts[count-1], lens[count-1])) return NULL;
+
+    hr_strbuf_t out = {0};
+    int ok = 1;
+    for (int i = 0; i < count - 1 && ok; i++) {
+        if (i > 0) sb_puts(&out, "::");
+        ok = legacy_ident(parts[i], lens[i], &out);
+    }
+    return sb_finish(&out, ok);
+}
+
+/* Rust v0 mangling (RFC 2603). */
+
+typedef struct {
+    const char*  sym;
+    size_t       len;
+    size_t       pos;
+    int          depth;
+    uint64_t     bound_lifetimes;
+    hr_strbuf_t* out;
+    int          error;
+} hr_v0_t;
+
+typedef struct {
+    const char* ascii;
+    size_t      ascii_len;
+    const char* punycode;
+    size_t      punycode_len;
+} hr_v0_ident_t;
+
+static void v0_path(hr_v0_t* v, int in_value);
+static void v0_type(hr_v0_t* v);
+static void v0_const(hr_v0_t* v);
+
+static int  v0_ok(const hr_v0_t* v)     { return !v->error; }
+static char v0_peek(const hr_v0_t* v)   { return v->pos < v->len ? v->sym[v->pos] : 0; }
+static void v0_fail(hr_v0_t* v)         { v->error = 1; }
+
+static int v0_eat(hr_v0_t* v, char c) {
+    if (v0_peek(v) != c) return 0;
+    v->pos++;
+    return 1;
+}
+
+static char v0_next(hr_v0_t* v) {
+    if (v->pos >= v->len) { v0_fail(v); return 0; }
+    return v->sym[v->pos++];
+}
+
+static uint64_t v0_integer_62(hr_v0_t* v) {
+    if (v0_eat(v, '_')) return 0;
+    uint64_t x = 0;
+    while (!v0_eat(v, '_')) {
+        char c = v0_next(v);
+        uint64_t d;
+        if      (c >= '0' && c <= '9') d = (uint64_t)(c - '0');
+        else if (c >= 'a' && c <= 'z') d = (uint64_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'Z') d = (uint64_t)(c - 'A' + 36);
+        else { v0_fail(v); return 0; }
+        if (x > (UINT64_MAX - d) / 62) { v0_fail(v); return 0; }
+        x = x * 62 + d;
+    }
+    if (x == UINT64_MAX) { v0_fail(v); return 0; }
+    return x + 1;
+}
+
+static uint64_t v0_opt_integer_62(hr_v0_t* v, char tag) {
+    if (!v0_eat(v, tag)) return 0;
+    uint64_t x = v0_integer_62(v);
+    if (x == UINT64_MAX) { v0_fail(v); return 0; }
+    return x + 1;
+}
+
+static uint64_t v0_disambiguator(hr_v0_t* v) {
+    return v0_opt_integer_62(v, 's');
+}
+
+static void v0_ident(hr_v0_t* v, hr_v0_ident_t* id) {
+    memset(id, 0, sizeof(*id));
+    int is_puny = v0_eat(v, 'u');
+    size_t len = 0;
+    char c = v0_next(v);
+    if (c < '0' || c > '9') { v0_fail(v); return; }
+    len = (size_t)(c - '0');
+    if (c != '0') {
+        while (v0_peek(v) >= '0' && v0_peek(v) <= '9') {
+            len = len * 10 + (size_t)(v0_next(v) - '0');
+            if (len > v->len) { v0_fail(v); return; }
+        }
+    }
+    v0_eat(v, '_');
+    if (len > v->len - v->pos) { v0_fail(v); return; }
+    const char* bytes = v->sym + v->pos;
+    v->pos += len;
+
+    if (!is_puny) {
+        id->ascii     = bytes;
+        id->ascii_len = len;
+        return;
+    }
+    const char* sep = NULL;
+    for (size_t i = len; i > 0; i--)
+        if (bytes[i-1] == '_') { sep = bytes + i - 1; break; }
+    if (sep) {
+        id->ascii        = bytes;
+        id->ascii_len    = (size_t)(sep - bytes);
+        id->punycode     = sep + 1;
+        id->punycode_len = len - id->ascii_len - 1;
+    } else {
+        id->punycode     = bytes;
+        id->punycode_len = len;
+    }
+    if (id->punycode_len == 0) v0_fail(v);
+}
+
+static uint64_t punycode_adapt(uint64_t delta, uint64_t points, int first) {
+    delta = first ? delta / 700 : delta / 2;
+    delta += delta / points;
+    uint64_t k = 0;
+    while (delta > 35 * 26 / 2) {
+        delta /= 35;
+        k += 36;
+    }
+    return k + 36 * delta / (delta + 38);
+}
+
+static int punycode_decode(const hr_v0_ident_t* id, hr_strbuf_t* out) {
+    uint32_t cps[HR_PUNYCODE_MAX];
+    size_t   count = 0;
+    if (id->ascii_len > HR_PUNYCODE_MAX) return 0;
+    for (size_t i = 0; i < id->ascii_len; i++) cps[count++] = (unsigned char)id->ascii[i];
+
+    uint64_t n = 128, i = 0, bias = 72;
+    int first = 1;
+    const char* p   = id->punycode;
+    const char* end = p + id->punycode_len;
+    while (p < end) {
+        uint64_t old_i = i, w = 1;
+        for (uint64_t k = 36; ; k += 36) {
+            if (p >= end) return 0;
+            char c = *p++;
+            uint64_t d;
+            if      (c >= 'a' && c <= 'z') d = (uint64_t)(c - 'a');
+            else if (c >= '0' && c <= '9') d = (uint64_t)(c - '0' + 26);
+            else return 0;
+            if (d > (UINT32_MAX - i) / w) return 0;
+            i += d * w;
+            uint64_t t = k <= bias ? 1 : (k >= bias + 26 ? 26 : k - bias);
+            if (d < t) break;
+            w *= 36 - t;
+            if (w > UINT32_MAX) return 0;
+        }
+        if (count >= HR_PUNYCODE_MAX) return 0;
+        bias  = punycode_adapt(i - old_i, count + 1, first);
+        first = 0;
+        n += i / (count + 1);
+        i %= count + 1;
+        if (n > 0x10FFFF) return 0;
+        memmove(&cps[i + 1], &cps[i], sizeof(uint32_t) * (count - i));
+        cps[i++] = (uint32_t)n;
+        count++;
+    }
+    for (size_t k = 0; k < count; k++) sb_put_utf8(out, cps[k]);
+    return 1;
+}
+
+static void v0_print_ident(hr_v0_t* v, const hr_v0_ident_t* id) {
+    if (!v->out || v->error) return;
+    if (!id->punycode) {
+        sb_putn(v->out, id->ascii, id->ascii_len);
+        return;
+    }
+    hr_strbuf_t decoded = {0};
+    if (punycode_decode(id, &decoded) && !decoded.error) {
+        sb_putn(v->out, decoded.data, decoded.len);
+    } else {
+        sb_puts(v->out, "punycode{");
+        if (id->ascii_len) {
+            sb_putn(v->out, id->ascii, id->ascii_len);
+            sb_putc(v->out, '-');
+        }
+        sb_putn(v->out, id->punycode, id->punycode_len);
+        sb_putc(v->out, '}');
+    }
+    free(decoded.data);
+}
+
+static int v0_enter(hr_v0_t* v) {
+    if (v->error) return 0;
+    if (++v->depth > HR_DEMANGLE_MAX_DEPTH) { v0_fail(v); return 0; }
+    return 1;
+}
+
+static int v0_backref(hr_v0_t* v, size_t* saved) {
+    size_t start = v->pos - 1;
+    uint64_t target = v0_integer_62(v);
+    if (v->error || target >= start) { v0_fail(v); return 0; }
+    *saved = v->pos;
+    v->pos = (size_t)target;
+    return 1;
+}
+
+static void v0_lifetime(hr_v0_t* v, uint64_t lt) {
+    sb_putc(v->out, '\'');
+    if (lt == 0) { sb_putc(v->out, '_'); return; }
+    if (lt > v->bound_lifetimes) { v0_fail(v); return; }
+    uint64_t depth = v->bound_lifetimes - lt;
+    if (depth < 26) {
+        sb_putc(v->out, (char)('a' + depth));
+    } else {
+        sb_putc(v->out, '_');
+        sb_put_u64(v->out, depth);
+    }
+}
+
+static uint64_t v0_open_binder(hr_v0_t* v) {
+    uint64_t bound = v0_opt_integer_62(v, 'G');
+    if (v->error || bound == 0) return 0;
+    sb_puts(v->out, "for<");
+    for (uint64_t i = 0; i < bound; i++) {
+        if (i > 0) sb_puts(v->out, ", ");
+        v->bound_lifetimes++;
+        v0_lifetime(v, 1);
+    }
+    sb_puts(v->out, "> ");
+    return bound;
+}
+
+static void v0_generic_arg(hr_v0_t* v) {
+    if (v0_eat(v, 'L')) {
+        v0_lifetime(v, v0_integer_62(v));
+    } else if (v0_eat(v, 'K')) {
+        v0_const(v);
+    } else {
+        v0_type(v);
+    }
+}
+
+static void v0_generic_args(hr_v0_t* v) {
+    for (int i = 0; v0_ok(v) && !v0_eat(v, 'E'); i++) {
+        if (i > 0) sb_puts(v->out, ", ");
+        v0_generic_arg(v);
+    }
+}
+
+static void v0_path(hr_v0_t* v, int in_value) {
+    if (!v0_enter(v)) return;
+    char tag = v0_next(v);
+    switch (tag) {
+    case 'C': {
+        v0_disambiguator(v);
+        hr_v0_ident_t id;
+        v0_ident(v, &id);
+        v0_print_ident(v, &id);
+        break;
+    }
+    case 'N': {
+        char ns = v0_next(v);
+        if (!((ns >= 'a' && ns <= 'z') || (ns >= 'A' && ns <= 'Z'))) { v0_fail(v); break; }
+        v0_path(v, in_value);
+        uint64_t dis = v0_disambiguator(v);
+        hr_v0_ident_t id;
+        v0_ident(v, &id);
+        if (ns >= 'A' && ns <= 'Z') {
+            sb_puts(v->out, "::{");
+            if      (ns == 'C') sb_puts(v->out, "closure");
+            else if (ns == 'S') sb_puts(v->out, "shim");
+            else                sb_putc(v->out, ns);
+            if (id.ascii_len || id.punycode_len) {
+                sb_putc(v->out, ':');
+                v0_print_ident(v, &id);
+            }
+            sb_putc(v->out, '#');
+            sb_put_u64(v->out, dis);
+            sb_putc(v->out, '}');
+        } else if (id.ascii_len || id.punycode_len) {
+            sb_puts(v->out, "::");
+            v0_print_ident(v, &id);
+        }
+        break;
+    }
+    case 'M':
+    case 'X':
+    case 'Y': {
+        if (tag != 'Y') {
+            v0_disambiguator(v);
+            hr_strbuf_t* out = v->out;
+            v->out = NULL;
+            v0_path(v, 0);
+            v->out = out;
+        }
+        sb_putc(v->out, '<');
+        v0_type(v);
+        if (tag != 'M') {
+            sb_puts(v->out, " as ");
+            v0_path(v, 0);
+        }
+        sb_putc(v->out, '>');
+        break;
+    }
+    case 'I':
+        v0_path(v, in_value);
+        if (in_value) sb_puts(v->out, "::");
+        sb_putc(v->out, '<');
+        v0_generic_args(v);
+        sb_putc(v->out, '>');
+        break;
+    case 'B': {
+        size_t saved;
+        if (v0_backref(v, &saved)) {
+            v0_path(v, in_value);
+            v->pos = saved;
+        }
+        break;
+    }
+    default:
+        v0_fail(v);
+    }
+    v->depth--;
+}
+
+static const char* v0_basic_type(char tag) {
+    switch (tag) {
+    case 'a': return "i8";
+    case 'b': return "bool";
+    case 'c': return "char";
+    case 'd': return "f64";
+    case 'e': return "str";
+    case 'f': return "f32";
+    case 'h': return "u8";
+    case 'i': return "isize";
+    case 'j': return "usize";
+    case 'l': return "i32";
+    case 'm': return "u32";
+    case 'n': return "i128";
+    case 'o': return "u128";
+    case 's': return "i16";
+    case 't': return "u16";
+    case 'u': return "()";
+    case 'v': return "...";
+    case 'x': return "i64";
+    case 'y': return "u64";
+    case 'z': return "!";
+    case 'p': return "_";
+    default:  return NULL;
+    }
+}
+
+static int v0_path_maybe_open_generics(hr_v0_t* v) {
+    if (v0_eat(v, 'B')) {
+        size_t saved;
+        int open = 0;
+        if (v0_backref(v, &saved)) {
+            open = v0_path_maybe_open_generics(v);
+            v->pos = saved;
+        }
+        return open;
+    }
+    if (v0_eat(v, 'I')) {
+        v0_path(v, 0);
+        sb_putc(v->out, '<');
+        v0_generic_args(v);
+        return 1;
+    }
+    v0_path(v, 0);
+    return 0;
+}
+
+static void v0_dyn_trait(hr_v0_t* v) {
+    int open = v0_path_maybe_open_generics(v);
+    while (v0_ok(v) && v0_eat(v, 'p')) {
+        sb_puts(v->out, open ? ", " : "<");
+        open = 1;
+        hr_v0_ident_t id;
+        v0_ident(v, &id);
+        v0_print_ident(v, &id);
+        sb_puts(v->out, " = ");
+        v0_type(v);
+    }
+    if (open) sb_putc(v->out, '>');
+}
+
+static void v0_fn_sig(hr_v0_t* v) {
+    uint64_t bound = v0_open_binder(v);
+    int is_unsafe = v0_eat(v, 'U');
+    if (is_unsafe) sb_puts(v->out, "unsafe ");
+    if (v0_eat(v, 'K')) {
+        sb_puts(v->out, "extern \"");
+        if (v0_eat(v, 'C')) {
+            sb_putc(v->out, 'C');
+        } else {
+            hr_v0_ident_t id;
+            v0_ident(v, &id);
+            for (size_t i = 0; i < id.ascii_len && v->out; i++)
+                sb_putc(v->out, id.ascii[i] == '_' ? '-' : id.ascii[i]);
+        }
+        sb_puts(v->out, "\" ");
+    }
+    sb_puts(v->out, "fn(");
+    for (int i = 0; v0_ok(v) && !v0_eat(v, 'E'); i++) {
+        if (i > 0) sb_puts(v->out, ", ");
+        v0_type(v);
+    }
+    sb_putc(v->out, ')');
+    if (!v0_eat(v, 'u')) {
+        sb_puts(v->out, " -> ");
+        v0_type(v);
+    }
+    v->bound_lifetimes -= bound;
+}
+
+static void v0_type(hr_v0_t* v) {
+    if (!v0_enter(v)) return;
+    char tag = v0_next(v);
+    const char* basic = v0_basic_type(tag);
+    if (basic) {
+        sb_puts(v->out, basic);
+        v->depth--;
+        return;
+    }
+    switch (tag) {
+    case 'R':
+    case 'Q':
+        sb_putc(v->out, '&');
+        if (v0_eat(v, 'L')) {
+            uint64_t lt = v0_integer_62(v);
+            if (lt != 0) {
+                v0_lifetime(v, lt);
+                sb_putc(v->out, ' ');
+            }
+        }
+        if (tag == 'Q') sb_puts(v->out, "mut ");
+        v0_type(v);
+        break;
+    case 'P':
+    case 'O':
+        sb_puts(v->out, tag == 'P' ? "*const " : "*mut ");
+        v0_type(v);
+        break;
+    case 'A':
+    case 'S':
+        sb_putc(v->out, '[');
+        v0_type(v);
+        if (tag == 'A') {
+            sb_puts(v->out, "; ");
+            v0_const(v);
+        }
+        sb_putc(v->out, ']');
+        break;
+    case 'T': {
+        sb_putc(v->out, '(');
+        int count = 0;
+        for (; v0_ok(v) && !v0_eat(v, 'E'); count++) {
+            if (count > 0) sb_puts(v->out, ", ");
+            v0_type(v);
+        }
+        if (count == 1) sb_putc(v->out, ',');
+        sb_putc(v->out, ')');
+        break;
+    }
+    case 'F':
+        v0_fn_sig(v);
+        break;
+    case 'D': {
+        sb_puts(v->out, "dyn ");
+        uint64_t bound = v0_open_binder(v);
+        for (int i = 0; v0_ok(v) && !v0_eat(v, 'E'); i++) {
+            if (i > 0) sb_puts(v->out, " + ");
+            v0_dyn_trait(v);
+        }
+        v->bound_lifetimes -= bound;
+        if (!v0_eat(v, 'L')) { v0_fail(v); break; }
+        uint64_t lt = v0_integer_62(v);
+        if (lt != 0) {
+            sb_puts(v->out, " + ");
+            v0_lifetime(v, lt);
+        }
+        break;
+    }
+    case 'B': {
+        size_t saved;
+        if (v0_backref(v, &saved)) {
+            v0_type(v);
+            v->pos = saved;
+        }
+        break;
+    }
+    default:
+        v->pos--;
+        v0_path(v, 0);
+        break;
+    }
+    v->depth--;
+}
+
+static void v0_const(hr_v0_t* v) {
+    if (!v0_enter(v)) return;
+    char tag = v0_next(v);
+    if (tag == 'B') {
+        size_t saved;
+        if (v0_backref(v, &saved)) {
+            v0_const(v);
+            v->pos = saved;
+        }
+        v->depth--;
+        return;
+    }
+    if (tag == 'p') {
+        sb_putc(v->out, '_');
+        v->depth--;
+        return;
+    }
+
+    int is_signed = strchr("aslxni", tag) != NULL;
+    int is_int    = is_signed || strchr("htmyoj", tag) != NULL;
+    if (!is_int && tag != 'b' && tag != 'c') { v0_fail(v); v->depth--; return; }
+
+    int negative = is_signed && v0_eat(v, 'n');
+    const char* hex = v->sym + v->pos;
+    size_t nibbles = 0;
+    while (v0_ok(v) && !v0_eat(v, '_')) {
+        char c = v0_next(v);
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) { v0_fail(v); break; }
+        nibbles++;
+    }
+    if (!v0_ok(v)) { v->depth--; return; }
+
+    uint64_t value = 0;
+    int fits = nibbles <= 16;
+    for (size_t i = 0; fits && i < nibbles; i++) {
+        char c = hex[i];
+        value = (value << 4) | (uint64_t)(c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+
+    if (tag == 'b') {
+        if (!fits || value > 1) v0_fail(v);
+        else sb_puts(v->out, value ? "true" : "false");
+    } else if (tag == 'c') {
+        if (!fits || value > 0x10FFFF) { v0_fail(v); }
+        else {
+            sb_putc(v->out, '\'');
+            if (v->out) sb_put_utf8(v->out, (uint32_t)value);
+            sb_putc(v->out, '\'');
+        }
+    } else {
+        if (negative) sb_putc(v->out, '-');
+        if (fits) {
+            sb_put_u64(v->out, value);
+        } else {
+            sb_puts(v->out, "0x");
+            sb_putn(v->out, hex, nibbles);
+        }
+        if (v->out) sb_puts(v->out, v0_basic_type(tag));
+    }
+    v->depth--;
+}
+
+static char* demangle_v0(const char* s) {
+    if      (strncmp(s, "__R", 3) == 0) s += 3;
+    else if (strncmp(s, "_R", 2) == 0)  s += 2;
+    else if (s[0] == 'R' && s[1] >= 'A' && s[1] <= 'Z') s += 1;
+    else return NULL;
+    if (*s >= '0' && *s <= '9') return NULL;
+
+    size_t len = 0;
+    while (s[len] && s[len] != '.') {
+        if ((unsigned char)s[len] >= 0x80) return NULL;
+        len++;
+    }
+
+    hr_strbuf_t out = {0};
+    hr_v0_t v;
+    memset(&v, 0, sizeof(v));
+    v.sym = s;
+    v.len = len;
+    v.out = &out;
+    v0_path(&v, 1);
+    if (!v.error && v.pos < v.len && v0_peek(&v) >= 'A' && v0_peek(&v) <= 'Z') {
+        v.out = NULL;
+        v0_path(&v, 0);
+    }
+    return sb_finish(&out, !v.error && v.pos == v.len);
+}
+
+char* hr_demangle_rust(const char* mangled) {
+    char* out = demangle_v0(mangled);
+    return out ? out : demangle_legacy(mangled);
+}
+
+/* Lookup keys: spaces are only kept between two identifier characters, so
+   "foo(int,char const*)" and "foo(int, char const *)" index the same. */
+
+static int is_ident_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || (unsigned char)c >= 0x80;
+}
+
+void hr_demangle_normalize(const char* name, char* out, size_t out_size) {
+    size_t n = 0;
+    int pending_space = 0;
+    if (out_size == 0) return;
+    for (const char* p = name; *p && n + 1 < out_size; p++) {
+        if (*p == ' ' || *p == '\t') {
+            pending_space = 1;
+            continue;
+        }
+        if (pending_space && n > 0 && is_ident_char(out[n-1]) && is_ident_char(*p) && n + 2 < out_size)
+            out[n++] = ' ';
+        pending_space = 0;
+        out[n++] = *p;
+    }
+    out[n] = 0;
+}
+
+int hr_demangle_base_name(const char* demangled, char* out, size_t out_size) {
+    size_t len = strlen(demangled);
+    const char* close = NULL;
+    for (size_t i = len; i > 0; i--) {
+        if (demangled[i-1] == ')') { close = demangled + i - 1; break; }
+    }
+    if (!close) return 0;
+    int depth = 0;
+    for (const char* p = close; p >= demangled; p--) {
+        if (*p == ')') depth++;
+        else if (*p == '(' && --depth == 0) {
+            size_t n = (size_t)(p - demangled);
+            if (n == 0 || n >= out_size) return 0;
+            memcpy(out, demangled, n);
+            out[n] = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
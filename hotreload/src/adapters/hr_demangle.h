@@ -0,0 +1,11 @@
+#ifndef HR_DEMANGLE_H
+#define HR_DEMANGLE_H
+
+#include <stddef.h>
+
+char* hr_demangle_itanium(const char* mangled);
+char* hr_demangle_rust(const char* mangled);
+void  hr_demangle_normalize(const char* name, char* out, size_t out_size);
+int   hr_demangle_base_name(const char* demangled, char* out, size_t out_size);
+
+#endif
@@ -0,0 +1,186 @@
+#include "hr_arena.h"
+#include "../platform/hr_platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HR_ARENA_X64 1
+#endif
+
+#define HR_ARENA_CHUNK (64 * 1024)
+#define HR_ARENA_SLOT  16
+#define HR_ARENA_REACH ((uint64_t)1 << 31)
+
+/* Slot layout: the 8-byte target first, so it can be replaced with one
+   aligned store, then `jmp [rip-14]` reading it back. */
+#define HR_ARENA_ENTRY 8
+
+#if defined(_MSC_VER)
+#define load_target(p)     (*(volatile uintptr_t*)(p))
+#define store_target(p, v) (*(volatile uintptr_t*)(p) = (v))
+#else
+#define load_target(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define store_target(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+typedef struct {
+    unsigned char* base;
+    int            used;
+} arena_chunk_t;
+
+typedef struct {
+    char*          name;
+    uint64_t       hash;
+    unsigned char* slot;
+} arena_slot_t;
+
+struct hr_arena {
+    arena_chunk_t* chunks;
+    int            chunk_count;
+    arena_slot_t*  slots;
+    int            count;
+    int            capacity;
+    int*           table;
+    int            table_size;
+};
+
+int hr_arena_supported(void) {
+#ifdef HR_ARENA_X64
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+hr_arena_t* hr_arena_create(void) {
+    return calloc(1, sizeof(hr_arena_t));
+}
+
+void hr_arena_destroy(hr_arena_t* arena) {
+    if (!arena) return;
+    for (int i = 0; i < arena->chunk_count; i++)
+        hr_platform_free_exec(arena->chunks[i].base, HR_ARENA_CHUNK);
+    for (int i = 0; i < arena->count; i++)
+        free(arena->slots[i].name);
+    free(arena->chunks);
+    free(arena->slots);
+    free(arena->table);
+    free(arena);
+}
+
+int hr_arena_count(const hr_arena_t* arena) {
+    return arena ? arena->count : 0;
+}
+
+/* A rel32 jump at `from` is 5 bytes long and counts from its end. */
+static int reachable(const void* from, const void* to) {
+    int64_t delta = (int64_t)((uintptr_t)to - ((uintptr_t)from + 5));
+    return delta >= -(int64_t)HR_ARENA_REACH && delta < (int64_t)HR_ARENA_REACH;
+}
+
+static int find(const hr_arena_t* arena, const char* name, uint64_t hash) {
+    if (!arena->table_size) return -1;
+    size_t mask = (size_t)arena->table_size - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        int idx = arena->table[i];
+        if (idx < 0) return -1;
+        if (arena->slots[idx].hash == hash && strcmp(arena->slots[idx].name, name) == 0) return idx;
+    }
+}
+
+static int table_grow(hr_arena_t* arena) {
+    int size = arena->table_size ? arena->table_size * 2 : 256;
+    int* table = malloc(sizeof(int) * (size_t)size);
+    if (!table) return 0;
+    memset(table, 0xFF, sizeof(int) * (size_t)size);
+    size_t mask = (size_t)size - 1;
+    for (int s = 0; s < arena->count; s++) {
+        size_t i = (size_t)arena->slots[s].hash & mask;
+        while (table[i] >= 0) i = (i + 1) & mask;
+        table[i] = s;
+    }
+    free(arena->table);
+    arena->table      = table;
+    arena->table_size = size;
+    return 1;
+}
+
+/* Returns a free slot reachable from `from`, mapping a new chunk near it
+   when none of the existing chunks has room in reach. */
+static unsigned char* take_slot(hr_arena_t* arena, const void* from) {
+    for (int i = 0; i < arena->chunk_count; i++) {
+        arena_chunk_t* c = &arena->chunks[i];
+        if (c->used + HR_ARENA_SLOT > HR_ARENA_CHUNK) continue;
+        if (!reachable(from, c->base) || !reachable(from, c->base + HR_ARENA_CHUNK)) continue;
+        unsigned char* slot = c->base + c->used;
+        c->used += HR_ARENA_SLOT;
+        return slot;
+    }
+    arena_chunk_t* chunks = realloc(arena->chunks, sizeof(arena_chunk_t) * (size_t)(arena->chunk_count + 1));
+    if (!chunks) return NULL;
+    arena->chunks = chunks;
+    unsigned char* base = hr_platform_alloc_exec_near(from, HR_ARENA_CHUNK, HR_ARENA_REACH);
+    if (!base) return NULL;
+    arena->chunks[arena->chunk_count].base = base;
+    arena->chunks[arena->chunk_count].used = HR_ARENA_SLOT;
+    arena->chunk_count++;
+    return base;
+}
+
+static void write_slot(unsigned char* slot) {
+    memset(slot, 0, HR_ARENA_ENTRY);
+    unsigned char* code = slot + HR_ARENA_ENTRY;
+    code[0] = 0xFF;
+    code[1] = 0x25;
+    code[2] = 0xF2;
+    code[3] = 0xFF;
+    code[4] = 0xFF;
+    code[5] = 0xFF;
+    code[6] = 0xCC;
+    code[7] = 0xCC;
+}
+
+void* hr_arena_slot(hr_arena_t* arena, const char* name, uint64_t hash, const void* from) {
+    if (!hr_arena_supported() || !arena || !name || !from) return NULL;
+    int idx = find(arena, name, hash);
+    if (idx >= 0) {
+        unsigned char* entry = arena->slots[idx].slot + HR_ARENA_ENTRY;
+        return reachable(from, entry) ? entry : NULL;
+    }
+
+    if (arena->count >= arena->capacity) {
+        int capacity = arena->capacity ? arena->capacity * 2 : 64;
+        arena_slot_t* slots = realloc(arena->slots, sizeof(arena_slot_t) * (size_t)capacity);
+        if (!slots) return NULL;
+        arena->slots    = slots;
+        arena->capacity = capacity;
+    }
+    if ((arena->count + 1) * 10 > arena->table_size * 7 && !table_grow(arena)) return NULL;
+
+    char* copy = strdup(name);
+    unsigned char* slot = copy ? take_slot(arena, from) : NULL;
+    if (!slot) { free(copy); return NULL; }
+    write_slot(slot);
+
+    arena_slot_t* s = &arena->slots[arena->count];
+    s->name = copy;
+    s->hash = hash;
+    s->slot = slot;
+    size_t mask = (size_t)arena->table_size - 1;
+    size_t i = (size_t)hash & mask;
+    while (arena->table[i] >= 0) i = (i + 1) & mask;
+    arena->table[i] = arena->count++;
+    return slot + HR_ARENA_ENTRY;
+}
+
+void* hr_arena_target(const void* entry) {
+    const uintptr_t* target = (const uintptr_t*)((const unsigned char*)entry - HR_ARENA_ENTRY);
+    return (void*)load_target(target);
+}
+
+/* Threads already inside the slot's jump read either the old or the new
+   target, never a torn one. */
+void hr_arena_set_target(void* entry, void* target) {
+    uintptr_t* slot = (uintptr_t*)((unsigned char*)entry - HR_ARENA_ENTRY);
+    store_target(slot, (uintptr_t)target);
+}
@@ -0,0 +1,24 @@
+#ifndef HR_ARENA_H
+#define HR_ARENA_H
+
+#include <stdint.h>
+
+/* Executable slots placed within rel32 reach of patched code. Each slot
+   holds an absolute jump to the newest definition of one function; every
+   generation of that function jumps into the same slot, so redirecting them
+   all again only rewrites the slot's target. */
+typedef struct hr_arena hr_arena_t;
+
+hr_arena_t* hr_arena_create(void);
+void        hr_arena_destroy(hr_arena_t* arena);
+int         hr_arena_supported(void);
+
+/* Returns the entry of the slot for `name`, creating it near `from` when it
+   does not exist yet, or NULL when no slot can be reached from `from`. */
+void*       hr_arena_slot(hr_arena_t* arena, const char* name, uint64_t hash, const void* from);
+void*       hr_arena_target(const void* entry);
+void        hr_arena_set_target(void* entry, void* target);
+
+int         hr_arena_count(const hr_arena_t* arena);
+
+#endif
@@ -0,0 +1,207 @@
+#include "hr_builder.h"
+#include "../platform/hr_platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HR_MAX_JOBS 64
+
+struct hr_builder {
+    hr_mutex_t*     lock;
+    hr_cond_t*      wake;
+    hr_cond_t*      idle;
+    hr_thread_t*    threads[HR_MAX_JOBS];
+    int             thread_count;
+    hr_build_job_t* queue;
+    hr_build_job_t* running;
+    hr_build_job_t* done;
+    int             stopping;
+    char            build_dir[4096];
+    const char*     flags;
+};
+
+static void push_tail(hr_build_job_t** list, hr_build_job_t* job) {
+    job->next = NULL;
+    while (*list) list = &(*list)->next;
+    *list = job;
+}
+
+static void unlink_job(hr_build_job_t** list, hr_build_job_t* job) {
+    while (*list && *list != job) list = &(*list)->next;
+    if (*list) *list = job->next;
+    job->next = NULL;
+}
+
+static void drop_owner(hr_build_job_t** list, void* owner) {
+    while (*list) {
+        hr_build_job_t* job = *list;
+        if (job->owner == owner) {
+            *list = job->next;
+            hr_builder_job_free(job);
+        } else {
+            list = &job->next;
+        }
+    }
+}
+
+static int cancel_running(hr_build_job_t* list, void* owner) {
+    int found = 0;
+    for (hr_build_job_t* job = list; job; job = job->next) {
+        if (job->owner == owner) {
+            job->cancel = 1;
+            found = 1;
+        }
+    }
+    return found;
+}
+
+static hr_build_job_t* pop_best(hr_builder_t* b) {
+    hr_build_job_t* best = b->queue;
+    for (hr_build_job_t* job = b->queue; job; job = job->next) {
+        if (job->priority > best->priority) best = job;
+    }
+    unlink_job(&b->queue, best);
+    return best;
+}
+
+static void worker_main(void* arg) {
+    hr_builder_t* b = (hr_builder_t*)arg;
+    hr_platform_mutex_lock(b->lock);
+    for (;;) {
+        while (!b->stopping && !b->queue)
+            hr_platform_cond_wait(b->wake, b->lock);
+        if (b->stopping) break;
+
+        hr_build_job_t* job = pop_best(b);
+        job->state = HR_JOB_RUNNING;
+        job->next  = b->running;
+        b->running = job;
+        hr_platform_mutex_unlock(b->lock);
+
+        job->result = hr_loader_build(job->module, b->build_dir, b->flags,
+                                      job->generation, &job->prev_deps, &job->cancel, &job->build);
+        job->finish_ns = hr_platform_time_ns();
+
+        hr_platform_mutex_lock(b->lock);
+        unlink_job(&b->running, job);
+        job->state = HR_JOB_DONE;
+        push_tail(&b->done, job);
+        hr_platform_cond_broadcast(b->idle);
+    }
+    hr_platform_mutex_unlock(b->lock);
+}
+
+hr_builder_t* hr_builder_create(const char* build_dir, const char* flags, int jobs) {
+    hr_builder_t* b = calloc(1, sizeof(hr_builder_t));
+    if (!b) return NULL;
+    strncpy(b->build_dir, build_dir, sizeof(b->build_dir)-1);
+    b->flags = flags;
+    b->lock  = hr_platform_mutex_create();
+    b->wake  = hr_platform_cond_create();
+    b->idle  = hr_platform_cond_create();
+
+    if (jobs <= 0) jobs = hr_platform_cpu_count();
+    if (jobs > HR_MAX_JOBS) jobs = HR_MAX_JOBS;
+    if (b->lock && b->wake && b->idle) {
+        while (b->thread_count < jobs) {
+            hr_thread_t* t = hr_platform_thread_start(worker_main, b);
+            if (!t) break;
+            b->threads[b->thread_count++] = t;
+        }
+    }
+    if (b->thread_count == 0) {
+        hr_platform_cond_destroy(b->idle);
+        hr_platform_cond_destroy(b->wake);
+        hr_platform_mutex_destroy(b->lock);
+        free(b);
+        return NULL;
+    }
+    return b;
+}
+
+void hr_builder_destroy(hr_builder_t* b) {
+    if (!b) return;
+    hr_platform_mutex_lock(b->lock);
+    b->stopping = 1;
+    for (hr_build_job_t* job = b->running; job; job = job->next)
+        job->cancel = 1;
+    hr_platform_cond_broadcast(b->wake);
+    hr_platform_mutex_unlock(b->lock);
+    for (int i = 0; i < b->thread_count; i++)
+        hr_platform_thread_join(b->threads[i]);
+
+    while (b->queue) {
+        hr_build_job_t* job = b->queue;
+        b->queue = job->next;
+        hr_builder_job_free(job);
+    }
+    while (b->done) {
+        hr_build_job_t* job = b->done;
+        b->done = job->next;
+        hr_builder_job_free(job);
+    }
+    hr_platform_cond_destroy(b->idle);
+    hr_platform_cond_destroy(b->wake);
+    hr_platform_mutex_destroy(b->lock);
+    free(b);
+}
+
+int hr_builder_jobs(const hr_builder_t* b) {
+    return b ? b->thread_count : 0;
+}
+
+void hr_builder_submit(hr_builder_t* b, hr_loaded_module_t* module, void* owner,
+                       uint64_t priority) {
+    hr_build_job_t* job = calloc(1, sizeof(hr_build_job_t));
+    if (!job) return;
+    job->module     = module;
+    job->owner      = owner;
+    job->generation = ++module->next_generation;
+    job->priority   = priority;
+    job->submit_ns  = hr_platform_time_ns();
+    /* hr_poll swaps module->deps while workers run, so each job hashes its own copy. */
+    if (!hr_deps_copy(&job->prev_deps, &module->deps)) {
+        free(job);
+        return;
+    }
+
+    hr_platform_mutex_lock(b->lock);
+    drop_owner(&b->queue, owner);
+    drop_owner(&b->done, owner);
+    cancel_running(b->running, owner);
+    push_tail(&b->queue, job);
+    hr_platform_cond_broadcast(b->wake);
+    hr_platform_mutex_unlock(b->lock);
+}
+
+void hr_builder_cancel(hr_builder_t* b, void* owner) {
+    if (!b) return;
+    hr_platform_mutex_lock(b->lock);
+    drop_owner(&b->queue, owner);
+    while (cancel_running(b->running, owner))
+        hr_platform_cond_wait(b->idle, b->lock);
+    drop_owner(&b->done, owner);
+    hr_platform_mutex_unlock(b->lock);
+}
+
+hr_build_job_t* hr_builder_take_done(hr_builder_t* b) {
+    if (!b) return NULL;
+#if !defined(_MSC_VER)
+    if (!__atomic_load_n(&b->done, __ATOMIC_ACQUIRE)) return NULL;
+#endif
+    hr_platform_mutex_lock(b->lock);
+    hr_build_job_t* job = b->done;
+    if (job) {
+        b->done   = job->next;
+        job->next = NULL;
+    }
+    hr_platform_mutex_unlock(b->lock);
+    return job;
+}
+
+void hr_builder_job_free(hr_build_job_t* job) {
+    if (!job) return;
+    if (job->state == HR_JOB_DONE && job->result == HR_OK)
+        hr_loader_discard(&job->build);
+    hr_deps_free(&job->prev_deps);
+    free(job);
+}
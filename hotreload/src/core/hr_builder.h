@@ -0,0 +1,38 @@
+#ifndef HR_BUILDER_H
+#define HR_BUILDER_H
+
+#include "hr_loader.h"
+
+typedef enum {
+    HR_JOB_QUEUED = 0,
+    HR_JOB_RUNNING,
+    HR_JOB_DONE
+} hr_job_state_t;
+
+typedef struct hr_build_job {
+    hr_loaded_module_t*  module;
+    void*                owner;
+    unsigned             generation;
+    uint64_t             priority;
+    volatile int         cancel;
+    hr_job_state_t       state;
+    hr_dep_list_t        prev_deps;
+    hr_result_t          result;
+    hr_build_t           build;
+    uint64_t             submit_ns;
+    uint64_t             finish_ns;
+    struct hr_build_job* next;
+} hr_build_job_t;
+
+typedef struct hr_builder hr_builder_t;
+
+hr_builder_t*   hr_builder_create(const char* build_dir, const char* flags, int jobs);
+void            hr_builder_destroy(hr_builder_t* b);
+int             hr_builder_jobs(const hr_builder_t* b);
+void            hr_builder_submit(hr_builder_t* b, hr_loaded_module_t* module, void* owner,
+                                  uint64_t priority);
+void            hr_builder_cancel(hr_builder_t* b, void* owner);
+hr_build_job_t* hr_builder_take_done(hr_builder_t* b);
+void            hr_builder_job_free(hr_build_job_t* job);
+
+#endif
@@ -0,0 +1,599 @@
+#include "hr_cache.h"
+#include "../platform/hr_platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HR_CACHE_VERSION       1
+#define HR_CACHE_MAX_ENTRIES   8
+#define HR_CACHE_MAX_COMPILERS 8
+#define HR_CACHE_EVICT_PCT     90
+#define HR_CACHE_WAIT_MS       10
+#define HR_CACHE_PATH_MAX      (4096 + 64)
+
+typedef struct {
+    const hr_adapter_t* adapter;
+    hr_hash128_t        id;
+} hr_compiler_id_t;
+
+struct hr_cache {
+    char             dir[4096];
+    char             ext[16];
+    uint64_t         max_bytes;
+    hr_mutex_t*      lock;
+    hr_cache_stats_t stats;
+    hr_compiler_id_t compilers[HR_CACHE_MAX_COMPILERS];
+    int              compiler_count;
+    unsigned         tmp_counter;
+};
+
+typedef struct {
+    hr_hash128_t artifact;
+    const char*  begin;
+    const char*  deps;
+    const char*  end;
+    int          dep_count;
+} manifest_entry_t;
+
+typedef struct {
+    char*       path;
+    const char* name;
+    int64_t     size;
+    int64_t     mtime;
+    int         manifest;
+    int         owned;
+    int         removed;
+} cache_file_t;
+
+typedef struct {
+    const hr_cache_t* cache;
+    cache_file_t*     files;
+    int               count;
+    int               capacity;
+    uint64_t          bytes;
+} cache_listing_t;
+
+static const char* base_name(const char* path) {
+    const char* slash = strrchr(path, '/');
+    const char* back  = strrchr(path, '\\');
+    if (back > slash) slash = back;
+    return slash ? slash + 1 : path;
+}
+
+/* Only artifacts (<hash><ext>) and manifests (<hash>.manifest) belong to
+   the cache proper; temporaries, locks and failure markers are owned by
+   whichever process is building and are never counted or evicted. */
+static int cache_entry_kind(const hr_cache_t* cache, const char* name, int* manifest) {
+    hr_hash128_t unused;
+    if (strlen(name) < 32 || !hr_hash_parse(name, &unused)) return 0;
+    const char* suffix = name + 32;
+    *manifest = strcmp(suffix, ".manifest") == 0;
+    return *manifest || strcmp(suffix, cache->ext) == 0;
+}
+
+static void on_cache_file(const char* path, int64_t size, int64_t mtime, void* userdata) {
+    cache_listing_t* l = (cache_listing_t*)userdata;
+    int manifest = 0;
+    if (!cache_entry_kind(l->cache, base_name(path), &manifest)) return;
+    l->bytes += (uint64_t)size;
+    if (l->count >= l->capacity) {
+        int capacity = l->capacity ? l->capacity * 2 : 64;
+        cache_file_t* files = realloc(l->files, sizeof(cache_file_t) * (size_t)capacity);
+        if (!files) return;
+        l->files    = files;
+        l->capacity = capacity;
+    }
+    char* copy = strdup(path);
+    if (!copy) return;
+    l->files[l->count].path     = copy;
+    l->files[l->count].name     = base_name(copy);
+    l->files[l->count].size     = size;
+    l->files[l->count].mtime    = mtime;
+    l->files[l->count].manifest = manifest;
+    l->files[l->count].owned    = 0;
+    l->files[l->count].removed  = 0;
+    l->count++;
+}
+
+static void free_listing(cache_listing_t* l) {
+    for (int i = 0; i < l->count; i++) free(l->files[i].path);
+    free(l->files);
+}
+
+static int by_mtime(const void* a, const void* b) {
+    int64_t ma = ((const cache_file_t*)a)->mtime;
+    int64_t mb = ((const cache_file_t*)b)->mtime;
+    return ma < mb ? -1 : ma > mb;
+}
+
+hr_cache_t* hr_cache_open(const char* dir, const char* ext, uint64_t max_bytes) {
+    hr_cache_t* c = calloc(1, sizeof(hr_cache_t));
+    if (!c) return NULL;
+    strncpy(c->dir, dir, sizeof(c->dir)-1);
+    strncpy(c->ext, ext, sizeof(c->ext)-1);
+    if (!hr_platform_mkdir(c->dir) || !(c->lock = hr_platform_mutex_create())) {
+        free(c);
+        return NULL;
+    }
+    c->max_bytes = max_bytes;
+
+    cache_listing_t listing = { c, NULL, 0, 0, 0 };
+    hr_platform_list_dir(c->dir, on_cache_file, &listing);
+    c->stats.bytes = listing.bytes;
+    free_listing(&listing);
+    return c;
+}
+
+void hr_cache_close(hr_cache_t* cache) {
+    if (!cache) return;
+    hr_platform_mutex_destroy(cache->lock);
+    free(cache);
+}
+
+void hr_cache_get_stats(hr_cache_t* cache, hr_cache_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!cache) return;
+    hr_platform_mutex_lock(cache->lock);
+    *out = cache->stats;
+    hr_platform_mutex_unlock(cache->lock);
+}
+
+void hr_cache_key_free(hr_cache_key_t* key) {
+    hr_platform_file_unlock(key->lock);
+    for (int i = 0; i < key->input_count; i++) free(key->inputs[i].path);
+    free(key->inputs);
+    memset(key, 0, sizeof(*key));
+}
+
+static hr_hash128_t compiler_identity(hr_cache_t* cache, const hr_adapter_t* adapter) {
+    hr_platform_mutex_lock(cache->lock);
+    for (int i = 0; i < cache->compiler_count; i++) {
+        if (cache->compilers[i].adapter == adapter) {
+            hr_hash128_t id = cache->compilers[i].id;
+            hr_platform_mutex_unlock(cache->lock);
+            return id;
+        }
+    }
+    hr_platform_mutex_unlock(cache->lock);
+
+    hr_hasher_t h;
+    hr_hash_init(&h, HR_CACHE_VERSION);
+    hr_hash_str(&h, adapter->compiler);
+    hr_hash_str(&h, adapter->linker_flag ? adapter->linker_flag : "");
+    char path[4096];
+    if (adapter->compiler && hr_platform_find_program(adapter->compiler, path, sizeof(path))) {
+        hr_hash_str(&h, path);
+        hr_hash_u64(&h, (uint64_t)hr_platform_file_size(path));
+        hr_hash_u64(&h, (uint64_t)hr_platform_file_mtime(path));
+    }
+    hr_hash128_t id = hr_hash_final(&h);
+
+    hr_platform_mutex_lock(cache->lock);
+    if (cache->compiler_count < HR_CACHE_MAX_COMPILERS) {
+        cache->compilers[cache->compiler_count].adapter = adapter;
+        cache->compilers[cache->compiler_count].id      = id;
+        cache->compiler_count++;
+    }
+    hr_platform_mutex_unlock(cache->lock);
+    return id;
+}
+
+static hr_cache_input_t* find_input(hr_cache_key_t* key, const char* path) {
+    for (int i = 0; i < key->input_count; i++)
+        if (strcmp(key->inputs[i].path, path) == 0) return &key->inputs[i];
+    return NULL;
+}
+
+static int input_hash(hr_cache_key_t* key, const char* path, hr_hash128_t* out) {
+    hr_cache_input_t* in = find_input(key, path);
+    if (in) { *out = in->hash; return 1; }
+    if (!hr_hash_file(path, out)) return 0;
+
+    if (key->input_count >= key->input_capacity) {
+        int capacity = key->input_capacity ? key->input_capacity * 2 : 16;
+        hr_cache_input_t* inputs = realloc(key->inputs, sizeof(hr_cache_input_t) * (size_t)capacity);
+        if (!inputs) return 1;
+        key->inputs         = inputs;
+        key->input_capacity = capacity;
+    }
+    char* copy = strdup(path);
+    if (!copy) return 1;
+    key->inputs[key->input_count].path = copy;
+    key->inputs[key->input_count].hash = *out;
+    key->input_count++;
+    return 1;
+}
+
+static char* read_file(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* buf = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    if (buf) {
+        *len = fread(buf, 1, (size_t)size, f);
+        buf[*len] = 0;
+    }
+    fclose(f);
+    return buf;
+}
+
+static const char* next_line(const char* p, const char* end) {
+    while (p < end && *p != '\n') p++;
+    return p < end ? p + 1 : end;
+}
+
+static int parse_manifest(const char* text, size_t len, manifest_entry_t* entries, int max) {
+    const char* p   = text;
+    const char* end = text + len;
+    int count = 0;
+    while (p < end && count < max) {
+        manifest_entry_t* e = &entries[count];
+        if (end - p < 34 || !hr_hash_parse(p, &e->artifact) || p[32] != ' ') break;
+        e->begin     = p;
+        e->dep_count = atoi(p + 33);
+        e->deps      = next_line(p, end);
+        p = e->deps;
+        for (int i = 0; i < e->dep_count; i++) {
+            if (end - p < 34 || p[32] != ' ') return count;
+            p = next_line(p, end);
+        }
+        e->end = p;
+        count++;
+    }
+    return count;
+}
+
+static int dep_line_path(const char* line, const char* end, char* out, size_t out_sz) {
+    const char* p = line + 33;
+    size_t n = 0;
+    while (p + n < end && p[n] != '\n') n++;
+    if (n == 0 || n >= out_sz) return 0;
+    memcpy(out, p, n);
+    out[n] = 0;
+    return 1;
+}
+
+static int entry_matches(hr_cache_key_t* key, const manifest_entry_t* e) {
+    const char* p = e->deps;
+    char path[4096];
+    for (int i = 0; i < e->dep_count; i++) {
+        hr_hash128_t want, have;
+        if (!hr_hash_parse(p, &want) || !dep_line_path(p, e->end, path, sizeof(path))) return 0;
+        if (!input_hash(key, path, &have) || !hr_hash_equal(want, have)) return 0;
+        p = next_line(p, e->end);
+    }
+    return 1;
+}
+
+static void entry_deps(const manifest_entry_t* e, hr_dep_list_t* deps) {
+    const char* p = e->deps;
+    char path[4096];
+    for (int i = 0; i < e->dep_count; i++) {
+        if (dep_line_path(p, e->end, path, sizeof(path))) hr_deps_add(deps, path);
+        p = next_line(p, e->end);
+    }
+}
+
+static void artifact_path(const hr_cache_t* cache, hr_hash128_t key, char* out, size_t out_sz) {
+    char hex[33];
+    hr_hash_hex(key, hex);
+    snprintf(out, out_sz, "%s/%s%s", cache->dir, hex, cache->ext);
+}
+
+static void side_path(const hr_cache_t* cache, hr_hash128_t key, const char* suffix,
+                      char* out, size_t out_sz) {
+    char hex[33];
+    hr_hash_hex(key, hex);
+    snprintf(out, out_sz, "%s/%s%s", cache->dir, hex, suffix);
+}
+
+static void lock_path(const hr_cache_t* cache, hr_hash128_t key, char* out, size_t out_sz) {
+    char hex[33];
+    hr_hash_hex(key, hex);
+    snprintf(out, out_sz, "%s/.%s.lock", cache->dir, hex);
+}
+
+static void manifest_path(const hr_cache_t* cache, hr_hash128_t key, char* out, size_t out_sz) {
+    side_path(cache, key, ".manifest", out, out_sz);
+}
+
+static void temp_path(hr_cache_t* cache, char* out, size_t out_sz) {
+    hr_platform_mutex_lock(cache->lock);
+    unsigned n = cache->tmp_counter++;
+    hr_platform_mutex_unlock(cache->lock);
+    snprintf(out, out_sz, "%s/tmp.%llx.%u", cache->dir,
+             (unsigned long long)hr_platform_time_ns(), n);
+}
+
+static int lookup(hr_cache_t* cache, hr_cache_key_t* key, const char* out_path, hr_dep_list_t* deps) {
+    char mpath[HR_CACHE_PATH_MAX];
+    manifest_path(cache, key->manifest, mpath, sizeof(mpath));
+    size_t len = 0;
+    char*  text = read_file(mpath, &len);
+    if (!text) return 0;
+
+    manifest_entry_t entries[HR_CACHE_MAX_ENTRIES];
+    int count = parse_manifest(text, len, entries, HR_CACHE_MAX_ENTRIES);
+    int hit   = 0;
+    for (int i = 0; i < count && !hit; i++) {
+        if (!entry_matches(key, &entries[i])) continue;
+        char apath[HR_CACHE_PATH_MAX];
+        artifact_path(cache, entries[i].artifact, apath, sizeof(apath));
+        if (!hr_platform_copy_file(apath, out_path)) continue;
+        entry_deps(&entries[i], deps);
+        hr_platform_file_touch(apath);
+        hr_platform_file_touch(mpath);
+        hit = 1;
+    }
+    free(text);
+    return hit;
+}
+
+static int failed_elsewhere(hr_cache_t* cache, hr_cache_key_t* key) {
+    char fpath[HR_CACHE_PATH_MAX];
+    side_path(cache, key->manifest, ".failed", fpath, sizeof(fpath));
+    size_t len = 0;
+    char*  text = read_file(fpath, &len);
+    if (!text) return 0;
+
+    const char* p   = text;
+    const char* end = text + len;
+    int matches = strncmp(p, "pid ", 4) == 0 && atoi(p + 4) != hr_platform_process_id();
+    char path[4096];
+    p = next_line(p, end);
+    while (p < end && matches) {
+        hr_hash128_t want, have;
+        if (end - p < 34 || p[32] != ' ' || !hr_hash_parse(p, &want) ||
+            !dep_line_path(p, end, path, sizeof(path)) ||
+            !input_hash(key, path, &have) || !hr_hash_equal(want, have))
+            matches = 0;
+        p = next_line(p, end);
+    }
+    free(text);
+    return matches;
+}
+
+hr_cache_result_t hr_cache_fetch(hr_cache_t* cache, const hr_adapter_t* adapter, const char* src_path,
+                                 const char* flags, const hr_dep_list_t* prev_deps, volatile int* cancel,
+                                 hr_cache_key_t* key, const char* out_path, hr_dep_list_t* deps) {
+    memset(key, 0, sizeof(*key));
+    if (!cache) return HR_CACHE_MISS;
+
+    char src[4096];
+    if (!hr_platform_realpath(src_path, src, sizeof(src))) return HR_CACHE_MISS;
+    if (!hr_hash_file(src, &key->source)) return HR_CACHE_MISS;
+
+    hr_hash128_t compiler = compiler_identity(cache, adapter);
+    hr_hasher_t h;
+    hr_hash_init(&h, HR_CACHE_VERSION);
+    hr_hash_str(&h, hr_platform_name());
+    hr_hash_str(&h, adapter->name);
+    hr_hash_u64(&h, compiler.lo);
+    hr_hash_u64(&h, compiler.hi);
+    hr_hash_str(&h, flags);
+    hr_hash_str(&h, src);
+    hr_hash_u64(&h, key->source.lo);
+    hr_hash_u64(&h, key->source.hi);
+    key->manifest = hr_hash_final(&h);
+    key->valid    = 1;
+
+    if (prev_deps) {
+        hr_hash128_t unused;
+        for (int i = 0; i < prev_deps->count; i++)
+            input_hash(key, prev_deps->paths[i], &unused);
+    }
+
+    char lpath[HR_CACHE_PATH_MAX];
+    lock_path(cache, key->manifest, lpath, sizeof(lpath));
+    hr_cache_result_t result = HR_CACHE_MISS;
+    int waited = 0;
+    for (;;) {
+        if (lookup(cache, key, out_path, deps)) {
+            result = HR_CACHE_HIT;
+            break;
+        }
+        key->lock = hr_platform_file_trylock(lpath);
+        if (key->lock) {
+            if (lookup(cache, key, out_path, deps)) {
+                hr_platform_file_unlock(key->lock);
+                key->lock = NULL;
+                result = HR_CACHE_HIT;
+            } else if (failed_elsewhere(cache, key)) {
+                result = HR_CACHE_FAILED;
+            }
+            break;
+        }
+        if (cancel && *cancel) {
+            result = HR_CACHE_CANCELLED;
+            break;
+        }
+        waited = 1;
+        hr_platform_sleep_ms(HR_CACHE_WAIT_MS);
+    }
+
+    hr_platform_mutex_lock(cache->lock);
+    if (result == HR_CACHE_HIT) cache->stats.hits++;
+    else                        cache->stats.misses++;
+    if (waited && result == HR_CACHE_HIT) cache->stats.shared++;
+    hr_platform_mutex_unlock(cache->lock);
+    return result;
+}
+
+void hr_cache_fail(hr_cache_t* cache, hr_cache_key_t* key) {
+    if (!cache || !key->valid || !key->lock) return;
+    char fpath[HR_CACHE_PATH_MAX], tmp[HR_CACHE_PATH_MAX], hex[33];
+    side_path(cache, key->manifest, ".failed", fpath, sizeof(fpath));
+    temp_path(cache, tmp, sizeof(tmp));
+    FILE* f = fopen(tmp, "wb");
+    if (!f) return;
+    fprintf(f, "pid %d\n", hr_platform_process_id());
+    for (int i = 0; i < key->input_count; i++) {
+        hr_hash_hex(key->inputs[i].hash, hex);
+        fprintf(f, "%s %s\n", hex, key->inputs[i].path);
+    }
+    if (fclose(f) != 0 || !hr_platform_rename(tmp, fpath)) remove(tmp);
+}
+
+static int by_name(const void* a, const void* b) {
+    return strcmp((*(const cache_file_t* const*)a)->name, (*(const cache_file_t* const*)b)->name);
+}
+
+static cache_file_t* find_file(cache_file_t** sorted, int count, const char* name) {
+    cache_file_t  key = { NULL, name, 0, 0, 0, 0, 0 };
+    cache_file_t* pkey = &key;
+    cache_file_t** found = bsearch(&pkey, sorted, (size_t)count, sizeof(cache_file_t*), by_name);
+    return found ? *found : NULL;
+}
+
+static uint64_t remove_file(hr_cache_t* cache, cache_file_t* f) {
+    if (f->removed || remove(f->path) != 0) return 0;
+    f->removed = 1;
+    cache->stats.evictions++;
+    return (uint64_t)f->size;
+}
+
+/* Call with a manifest listed in `sorted`: collects the artifacts its
+   entries point to, or removes them when `evict` is set. */
+static uint64_t manifest_artifacts(hr_cache_t* cache, cache_file_t* m, cache_file_t** sorted,
+                                   int count, int evict) {
+    size_t len = 0;
+    char*  text = read_file(m->path, &len);
+    if (!text) return 0;
+    manifest_entry_t entries[HR_CACHE_MAX_ENTRIES];
+    int n = parse_manifest(text, len, entries, HR_CACHE_MAX_ENTRIES);
+    uint64_t freed = 0;
+    for (int i = 0; i < n; i++) {
+        char name[64];
+        hr_hash_hex(entries[i].artifact, name);
+        strncat(name, cache->ext, sizeof(name) - strlen(name) - 1);
+        cache_file_t* a = find_file(sorted, count, name);
+        if (!a) continue;
+        if (evict) freed += remove_file(cache, a);
+        else       a->owned = 1;
+    }
+    free(text);
+    return freed;
+}
+
+/* Least recently used manifests go first, together with their artifacts;
+   artifacts no manifest points to anymore are evicted on their own. */
+static void evict_locked(hr_cache_t* cache) {
+    cache_listing_t listing = { cache, NULL, 0, 0, 0 };
+    hr_platform_list_dir(cache->dir, on_cache_file, &listing);
+    qsort(listing.files, (size_t)listing.count, sizeof(cache_file_t), by_mtime);
+
+    cache_file_t** sorted = malloc(sizeof(cache_file_t*) * (size_t)(listing.count + 1));
+    if (!sorted) { free_listing(&listing); return; }
+    for (int i = 0; i < listing.count; i++) sorted[i] = &listing.files[i];
+    qsort(sorted, (size_t)listing.count, sizeof(cache_file_t*), by_name);
+    for (int i = 0; i < listing.count; i++)
+        if (listing.files[i].manifest)
+            manifest_artifacts(cache, &listing.files[i], sorted, listing.count, 0);
+
+    uint64_t target = cache->max_bytes / 100 * HR_CACHE_EVICT_PCT;
+    uint64_t bytes  = listing.bytes;
+    for (int i = 0; i < listing.count && bytes > target; i++) {
+        cache_file_t* f = &listing.files[i];
+        if (f->removed || (!f->manifest && f->owned)) continue;
+        if (f->manifest) bytes -= manifest_artifacts(cache, f, sorted, listing.count, 1);
+        bytes -= remove_file(cache, f);
+    }
+    cache->stats.bytes = bytes;
+    free(sorted);
+    free_listing(&listing);
+}
+
+static int write_manifest(const char* tmp, const char* mpath, hr_hash128_t artifact,
+                          const hr_dep_list_t* deps, const hr_hash128_t* hashes,
+                          int64_t* size_delta) {
+    size_t old_len = 0;
+    char*  old = read_file(mpath, &old_len);
+    manifest_entry_t entries[HR_CACHE_MAX_ENTRIES];
+    int count = old ? parse_manifest(old, old_len, entries, HR_CACHE_MAX_ENTRIES) : 0;
+
+    FILE* f = fopen(tmp, "wb");
+    if (!f) { free(old); return 0; }
+
+    char hex[33];
+    hr_hash_hex(artifact, hex);
+    fprintf(f, "%s %d\n", hex, deps->count);
+    for (int i = 0; i < deps->count; i++) {
+        hr_hash_hex(hashes[i], hex);
+        fprintf(f, "%s %s\n", hex, deps->paths[i]);
+    }
+    int kept = 1;
+    for (int i = 0; i < count && kept < HR_CACHE_MAX_ENTRIES; i++) {
+        if (hr_hash_equal(entries[i].artifact, artifact)) continue;
+        fwrite(entries[i].begin, 1, (size_t)(entries[i].end - entries[i].begin), f);
+        kept++;
+    }
+    long new_len = ftell(f);
+    int ok = fclose(f) == 0;
+    free(old);
+
+    if (!ok || !hr_platform_rename(tmp, mpath)) {
+        remove(tmp);
+        return 0;
+    }
+    *size_delta = (int64_t)new_len - (int64_t)old_len;
+    return 1;
+}
+
+void hr_cache_store(hr_cache_t* cache, hr_cache_key_t* key, const char* src_path,
+                    const char* artifact, const hr_dep_list_t* deps) {
+    if (!cache || !key->valid) return;
+
+    char src[4096];
+    hr_hash128_t now;
+    if (!hr_platform_realpath(src_path, src, sizeof(src))) return;
+    if (!hr_hash_file(src, &now) || !hr_hash_equal(now, key->source)) return;
+
+    hr_hash128_t* hashes = malloc(sizeof(hr_hash128_t) * (size_t)(deps->count + 1));
+    if (!hashes) return;
+    hr_hasher_t h;
+    hr_hash_init(&h, HR_CACHE_VERSION);
+    hr_hash_u64(&h, key->manifest.lo);
+    hr_hash_u64(&h, key->manifest.hi);
+    for (int i = 0; i < deps->count; i++) {
+        if (!hr_hash_file(deps->paths[i], &hashes[i])) { free(hashes); return; }
+        hr_cache_input_t* seen = find_input(key, deps->paths[i]);
+        if (seen && !hr_hash_equal(seen->hash, hashes[i])) { free(hashes); return; }
+        hr_hash_str(&h, deps->paths[i]);
+        hr_hash_u64(&h, hashes[i].lo);
+        hr_hash_u64(&h, hashes[i].hi);
+    }
+    hr_hash128_t akey = hr_hash_final(&h);
+
+    char apath[HR_CACHE_PATH_MAX], mpath[HR_CACHE_PATH_MAX];
+    char tmp[HR_CACHE_PATH_MAX], mtmp[HR_CACHE_PATH_MAX];
+    artifact_path(cache, akey, apath, sizeof(apath));
+    manifest_path(cache, key->manifest, mpath, sizeof(mpath));
+    temp_path(cache, tmp, sizeof(tmp));
+    temp_path(cache, mtmp, sizeof(mtmp));
+
+    int64_t added = 0;
+    if (!hr_platform_file_exists(apath)) {
+        if (!hr_platform_copy_file(artifact, tmp) || !hr_platform_rename(tmp, apath)) {
+            remove(tmp);
+            free(hashes);
+            return;
+        }
+        added = hr_platform_file_size(apath);
+    }
+
+    hr_platform_mutex_lock(cache->lock);
+    int64_t delta = 0;
+    if (write_manifest(mtmp, mpath, akey, deps, hashes, &delta)) {
+        char fpath[HR_CACHE_PATH_MAX];
+        side_path(cache, key->manifest, ".failed", fpath, sizeof(fpath));
+        remove(fpath);
+        cache->stats.stores++;
+        cache->stats.bytes += (uint64_t)(added + delta);
+        if (cache->max_bytes > 0 && cache->stats.bytes > cache->max_bytes)
+            evict_locked(cache);
+    }
+    hr_platform_mutex_unlock(cache->lock);
+    free(hashes);
+}
@@ -0,0 +1,53 @@
+#ifndef HR_CACHE_H
+#define HR_CACHE_H
+
+#include "hr_hash.h"
+#include "hr_deps.h"
+#include "../adapters/hr_adapter.h"
+#include "../platform/hr_platform.h"
+
+typedef struct hr_cache hr_cache_t;
+
+typedef enum {
+    HR_CACHE_MISS = 0,
+    HR_CACHE_HIT,
+    HR_CACHE_FAILED,
+    HR_CACHE_CANCELLED
+} hr_cache_result_t;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t shared;
+    uint64_t evictions;
+    uint64_t bytes;
+} hr_cache_stats_t;
+
+typedef struct {
+    char*        path;
+    hr_hash128_t hash;
+} hr_cache_input_t;
+
+typedef struct {
+    int               valid;
+    hr_hash128_t      manifest;
+    hr_hash128_t      source;
+    hr_cache_input_t* inputs;
+    int               input_count;
+    int               input_capacity;
+    hr_file_lock_t*   lock;
+} hr_cache_key_t;
+
+hr_cache_t* hr_cache_open(const char* dir, const char* ext, uint64_t max_bytes);
+void        hr_cache_close(hr_cache_t* cache);
+hr_cache_result_t hr_cache_fetch(hr_cache_t* cache, const hr_adapter_t* adapter, const char* src_path,
+                                 const char* flags, const hr_dep_list_t* prev_deps, volatile int* cancel,
+                                 hr_cache_key_t* key, const char* out_path, hr_dep_list_t* deps);
+void        hr_cache_fail(hr_cache_t* cache, hr_cache_key_t* key);
+void        hr_cache_store(hr_cache_t* cache, hr_cache_key_t* key, const char* src_path,
+                           const char* artifact, const hr_dep_list_t* deps);
+void        hr_cache_key_free(hr_cache_key_t* key);
+void        hr_cache_get_stats(hr_cache_t* cache, hr_cache_stats_t* out);
+
+#endif
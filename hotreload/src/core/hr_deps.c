@@ -0,0 +1,98 @@
+#include "hr_deps.h"
+#include "../platform/hr_platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void hr_deps_init(hr_dep_list_t* list) {
+    list->paths    = NULL;
+    list->count    = 0;
+    list->capacity = 0;
+}
+
+void hr_deps_free(hr_dep_list_t* list) {
+    for (int i = 0; i < list->count; i++)
+        free(list->paths[i]);
+    free(list->paths);
+    hr_deps_init(list);
+}
+
+int hr_deps_add(hr_dep_list_t* list, const char* path) {
+    for (int i = 0; i < list->count; i++)
+        if (strcmp(list->paths[i], path) == 0) return 1;
+    if (list->count >= list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        char** paths = realloc(list->paths, sizeof(char*) * (size_t)capacity);
+        if (!paths) return 0;
+        list->paths    = paths;
+        list->capacity = capacity;
+    }
+    char* copy = strdup(path);
+    if (!copy) return 0;
+    list->paths[list->count++] = copy;
+    return 1;
+}
+
+int hr_deps_copy(hr_dep_list_t* dst, const hr_dep_list_t* src) {
+    hr_deps_init(dst);
+    for (int i = 0; i < src->count; i++) {
+        if (!hr_deps_add(dst, src->paths[i])) {
+            hr_deps_free(dst);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void add_resolved(hr_dep_list_t* out, const char* path) {
+    char resolved[4096];
+    if (hr_platform_realpath(path, resolved, sizeof(resolved)))
+        hr_deps_add(out, resolved);
+}
+
+int hr_deps_parse_file(const char* depfile, hr_dep_list_t* out) {
+    FILE* f = fopen(depfile, "rb");
+    if (!f) return 0;
+
+    char token[4096];
+    size_t len = 0;
+    int in_deps = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\\') {
+            int next = fgetc(f);
+            if (next == '\n') continue;
+            if (next == '\r') { fgetc(f); continue; }
+            if (next == ' ' || next == '#') c = next;
+            else if (next != EOF) ungetc(next, f);
+        } else if (c == '$') {
+            int next = fgetc(f);
+            if (next != '$' && next != EOF) ungetc(next, f);
+        } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (len > 0) {
+                token[len] = 0;
+                if (!in_deps && token[len-1] == ':') in_deps = 1;
+                else if (in_deps) add_resolved(out, token);
+                len = 0;
+            }
+            if (c == '\n') in_deps = 0;
+            continue;
+        } else if (c == ':' && !in_deps) {
+            int next = fgetc(f);
+            if (next == ' ' || next == '\t' || next == '\n' || next == '\r' || next == EOF) {
+                in_deps = 1;
+                len = 0;
+                if (next == '\n') in_deps = 0;
+                continue;
+            }
+            ungetc(next, f);
+        }
+        if (len < sizeof(token) - 1) token[len++] = (char)c;
+    }
+    if (len > 0 && in_deps) {
+        token[len] = 0;
+        add_resolved(out, token);
+    }
+    fclose(f);
+    return 1;
+}
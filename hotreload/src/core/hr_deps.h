@@ -0,0 +1,16 @@
+#ifndef HR_DEPS_H
+#define HR_DEPS_H
+
+typedef struct {
+    char** paths;
+    int    count;
+    int    capacity;
+} hr_dep_list_t;
+
+void hr_deps_init(hr_dep_list_t* list);
+void hr_deps_free(hr_dep_list_t* list);
+int  hr_deps_add(hr_dep_list_t* list, const char* path);
+int  hr_deps_copy(hr_dep_list_t* dst, const hr_dep_list_t* src);
+int  hr_deps_parse_file(const char* depfile, hr_dep_list_t* out);
+
+#endif
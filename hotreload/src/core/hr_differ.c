@@ -1,70 +1,847 @@
 #include "hr_differ.h"
+#include "hr_hash.h"
+#include "hr_symbols.h"
+#include "../platform/hr_platform.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#define HR_DIFFER_SEED      0x4852444946460001ULL
+#define HR_DIFFER_MAX_SCOPE 32
+#define HR_DIFFER_MAX_NAME  256
+#define HR_DIFFER_INDEX_MIN 32
+
+typedef enum {
+    TOK_EOF = 0,
+    TOK_IDENT,
+    TOK_NUMBER,
+    TOK_STRING,
+    TOK_PUNCT,
+    TOK_DIRECTIVE,
+    TOK_DIRECTIVE_END
+} tok_kind_t;
+
+/* Whitespace that changes meaning: before a token inside a directive
+   (#define F(x) vs #define F (x), <a b.h>) and line breaks in Go. */
+enum {
+    LAYOUT_SPACE   = 1,
+    LAYOUT_NEWLINE = 2
+};
+
+typedef struct {
+    tok_kind_t  kind;
+    const char* text;
+    size_t      len;
+    int         newline;
+    int         layout;
+} token_t;
+
+typedef struct {
+    const char* p;
+    const char* end;
+    int         line_start;
+    int         in_directive;
+    int         keep_newlines;
+} lexer_t;
+
+typedef struct {
+    hr_snapshot_t* snap;
+    int            go_semicolons;
+    token_t*       toks;
+    int            count;
+    int            capacity;
+    int            brace;
+    int            paren;
+    int            bracket;
+    int            closed;
+    char           scope[HR_DIFFER_MAX_SCOPE][HR_DIFFER_MAX_NAME];
+    int            scope_depth;
+    hr_hasher_t    file;
+} segmenter_t;
+
+typedef struct {
+    char*         path;
+    uint64_t      hash;
+    int64_t       size;
+    int64_t       mtime;
+    hr_snapshot_t snap;
+} hr_tracked_t;
+
+struct hr_differ {
+    hr_tracked_t* files;
+    int           count;
+    int           capacity;
+    int*          index;
+    int           index_capacity;
+};
+
 static char* read_file(const char* path, size_t* out_size) {
     FILE* f = fopen(path, "rb");
     if (!f) return NULL;
     fseek(f, 0, SEEK_END);
     long sz = ftell(f);
     rewind(f);
-    char* buf = malloc((size_t)sz + 1);
+    char* buf = sz >= 0 ? malloc((size_t)sz + 1) : NULL;
     if (!buf) { fclose(f); return NULL; }
-    fread(buf, 1, (size_t)sz, f);
-    buf[sz] = 0;
+    size_t n = fread(buf, 1, (size_t)sz, f);
+    buf[n] = 0;
     fclose(f);
-    if (out_size) *out_size = (size_t)sz;
+    if (out_size) *out_size = n;
     return buf;
 }
 
-static int contains_keyword(const char* src, const char* kw) {
-    return strstr(src, kw) != NULL;
+static int is_ident_start(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$' || c >= 0x80;
+}
+
+static int is_ident_char(unsigned char c) {
+    return is_ident_start(c) || (c >= '0' && c <= '9');
+}
+
+static int is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static const char* const operators[] = {
+    "<<=", ">>=", "...", "->*", "<=>",
+    "::", "->", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "##", ".*", "=>", "..", ":=",
+    NULL
+};
+
+static const char* skip_quoted(const char* p, const char* end, char quote) {
+    for (p++; p < end && *p != quote && *p != '\n'; p++)
+        if (*p == '\\' && p + 1 < end) p++;
+    return p < end && *p == quote ? p + 1 : p;
+}
+
+static const char* skip_rust_raw(const char* p, const char* end) {
+    int hashes = 0;
+    while (p < end && *p == '#') { hashes++; p++; }
+    if (p >= end || *p != '"') return NULL;
+    for (p++; p < end; p++) {
+        if (*p != '"') continue;
+        int n = 0;
+        while (n < hashes && p + 1 + n < end && p[1 + n] == '#') n++;
+        if (n == hashes) return p + 1 + n;
+    }
+    return end;
 }
 
-static int has_header_change(const char* diff_content) {
-    return contains_keyword(diff_content, "struct ")  ||
-           contains_keyword(diff_content, "typedef ") ||
-           contains_keyword(diff_content, "#include ") ||
-           contains_keyword(diff_content, "#define ");
+static const char* skip_cpp_raw(const char* p, const char* end) {
+    const char* open = p + 1;
+    const char* paren = open;
+    while (paren < end && *paren != '(' && paren - open < 16) paren++;
+    if (paren >= end || *paren != '(') return NULL;
+    size_t delim = (size_t)(paren - open);
+    for (const char* q = paren + 1; q < end; q++) {
+        if (*q == ')' && q + 1 + delim < end && memcmp(q + 1, open, delim) == 0 && q[1 + delim] == '"')
+            return q + 2 + delim;
+    }
+    return end;
 }
 
-static int has_signature_change(const char* old_src, const char* new_src) {
-    const char* o = old_src;
-    const char* n = new_src;
-    while (*o && *n) {
-        if (*o == '{' && *n == '{') break;
-        if (*o != *n) return 1;
-        o++; n++;
+static int lex_next(lexer_t* lx, token_t* t) {
+    int newline = 0;
+    int space   = 0;
+    t->layout = 0;
+    for (;;) {
+        if (lx->p >= lx->end) {
+            t->newline = newline;
+            if (lx->in_directive) {
+                lx->in_directive = 0;
+                t->kind = TOK_DIRECTIVE_END;
+                t->text = "\n";
+                t->len  = 1;
+                return 1;
+            }
+            t->kind = TOK_EOF;
+            t->len  = 0;
+            return 0;
+        }
+        char c = *lx->p;
+        if (c == '\\' && lx->p + 1 < lx->end && (lx->p[1] == '\n' || lx->p[1] == '\r')) {
+            lx->p += lx->p[1] == '\r' && lx->p + 2 < lx->end && lx->p[2] == '\n' ? 3 : 2;
+        } else if (c == '\n') {
+            lx->p++;
+            newline        = 1;
+            lx->line_start = 1;
+            if (lx->in_directive) {
+                lx->in_directive = 0;
+                t->kind    = TOK_DIRECTIVE_END;
+                t->text    = "\n";
+                t->len     = 1;
+                t->newline = 1;
+                return 1;
+            }
+        } else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            lx->p++;
+            space = 1;
+        } else if (c == '/' && lx->p + 1 < lx->end && lx->p[1] == '/') {
+            while (lx->p < lx->end && *lx->p != '\n') lx->p++;
+        } else if (c == '/' && lx->p + 1 < lx->end && lx->p[1] == '*') {
+            space = 1;
+            const char* close = NULL;
+            for (const char* q = lx->p + 2; q + 1 < lx->end; q++)
+                if (q[0] == '*' && q[1] == '/') { close = q + 2; break; }
+            lx->p = close ? close : lx->end;
+        } else {
+            break;
+        }
+    }
+
+    const char* start = lx->p;
+    const char* end   = lx->end;
+    const char* p     = start;
+    int at_line_start = lx->line_start;
+    lx->line_start = 0;
+    t->newline = newline;
+    t->text    = start;
+    t->kind    = TOK_PUNCT;
+    if (lx->in_directive && space) t->layout |= LAYOUT_SPACE;
+    if (lx->keep_newlines && newline) t->layout |= LAYOUT_NEWLINE;
+
+    if (*p == '#' && at_line_start && !lx->in_directive) {
+        const char* q = p + 1;
+        while (q < end && (*q == ' ' || *q == '\t')) q++;
+        if (q < end && is_ident_start((unsigned char)*q)) {
+            lx->in_directive = 1;
+            t->kind = TOK_DIRECTIVE;
+        }
+        p++;
+    } else if (is_ident_start((unsigned char)*p)) {
+        while (p < end && is_ident_char((unsigned char)*p)) p++;
+        size_t len = (size_t)(p - start);
+        const char* raw = NULL;
+        if (p < end && (*p == '"' || *p == '#') &&
+            ((len == 1 && start[0] == 'r') || (len == 2 && start[0] == 'b' && start[1] == 'r')))
+            raw = skip_rust_raw(p, end);
+        else if (p < end && *p == '"' && start[len - 1] == 'R')
+            raw = skip_cpp_raw(p, end);
+        else if (p < end && (*p == '"' || *p == '\'') &&
+                 (len <= 2 && (start[0] == 'L' || start[0] == 'u' || start[0] == 'U' || start[0] == 'b')))
+            raw = skip_quoted(p, end, *p);
+        if (raw) {
+            p = raw;
+            t->kind = TOK_STRING;
+        } else {
+            t->kind = TOK_IDENT;
+        }
+    } else if (is_digit(*p) || (*p == '.' && p + 1 < end && is_digit(p[1]))) {
+        while (p < end) {
+            if ((*p == 'e' || *p == 'E' || *p == 'p' || *p == 'P') && p + 1 < end &&
+                (p[1] == '+' || p[1] == '-'))
+                p += 2;
+            else if (is_ident_char((unsigned char)*p) || *p == '.' || *p == '\'')
+                p++;
+            else
+                break;
+        }
+        t->kind = TOK_NUMBER;
+    } else if (*p == '"') {
+        p = skip_quoted(p, end, '"');
+        t->kind = TOK_STRING;
+    } else if (*p == '\'') {
+        const char* q = p + 1;
+        if (q < end && *q == '\\') {
+            p = skip_quoted(p, end, '\'');
+            t->kind = TOK_STRING;
+        } else {
+            while (q < end && q - p < 5 && *q != '\'' && *q != '\n') q++;
+            int utf8 = q - p == 2 || (q - p > 2 && (unsigned char)p[1] >= 0x80);
+            if (q < end && *q == '\'' && utf8) {
+                p = q + 1;
+                t->kind = TOK_STRING;
+            } else {
+                p++;
+            }
+        }
+    } else {
+        size_t len = 1;
+        for (int i = 0; operators[i]; i++) {
+            size_t n = strlen(operators[i]);
+            if ((size_t)(end - p) >= n && memcmp(p, operators[i], n) == 0) { len = n; break; }
+        }
+        p += len;
     }
+    t->len = (size_t)(p - start);
+    lx->p  = p;
+    return 1;
+}
+
+static int tok_is(const token_t* t, const char* s) {
+    size_t n = strlen(s);
+    return t->len == n && memcmp(t->text, s, n) == 0;
+}
+
+static int tok_in(const token_t* t, const char* const* words) {
+    for (int i = 0; words[i]; i++)
+        if (tok_is(t, words[i])) return 1;
     return 0;
 }
 
-hr_change_type_t hr_differ_analyze(const char* old_path, const char* new_path) {
-    if (!old_path || !new_path) return HR_CHANGE_FULL;
+static void name_append(char* name, const char* text, size_t len) {
+    size_t n = strlen(name);
+    if (n + len >= HR_DIFFER_MAX_NAME) len = HR_DIFFER_MAX_NAME - 1 - n;
+    memcpy(name + n, text, len);
+    name[n + len] = 0;
+}
+
+static void hash_token(hr_hasher_t* h, const token_t* t) {
+    unsigned char head[2] = { (unsigned char)t->kind, (unsigned char)t->layout };
+    hr_hash_update(h, head, 2);
+    hr_hash_update(h, t->text, t->len);
+}
+
+static const char* const prefix_words[] = {
+    "pub", "export", "extern", "static", "inline", "unsafe", "async", "virtual",
+    "constexpr", "consteval", "explicit", "friend", "noinline", "__inline", "__forceinline", NULL
+};
 
-    size_t old_sz, new_sz;
-    char* old_src = read_file(old_path, &old_sz);
-    char* new_src = read_file(new_path, &new_sz);
+static const char* const not_names[] = {
+    "fn", "func", "if", "while", "for", "switch", "return", "sizeof", "alignof", "alignas",
+    "decltype", "noexcept", "throw", "requires", "__attribute__", "__declspec", "typeof", NULL
+};
 
-    if (!old_src || !new_src) {
-        free(old_src); free(new_src);
-        return HR_CHANGE_FULL;
+static int skip_group(const token_t* t, int i, int n, const char* open, const char* close) {
+    int depth = 0;
+    for (; i < n; i++) {
+        if (tok_is(&t[i], open)) depth++;
+        else if (tok_is(&t[i], close) && --depth == 0) return i + 1;
     }
+    return n;
+}
 
-    if (old_sz == new_sz && memcmp(old_src, new_src, old_sz) == 0) {
-        free(old_src); free(new_src);
-        return HR_CHANGE_NONE;
+static int skip_prefix(const token_t* t, int n) {
+    int i = 0;
+    while (i < n) {
+        if (i + 1 < n && tok_is(&t[i], "#") && tok_is(&t[i + 1], "[")) {
+            i = skip_group(t, i + 1, n, "[", "]");
+        } else if (i + 1 < n && tok_is(&t[i], "template") && tok_is(&t[i + 1], "<")) {
+            i = skip_group(t, i + 1, n, "<", ">");
+        } else if (i + 1 < n && (tok_is(&t[i], "__attribute__") || tok_is(&t[i], "__declspec")) &&
+                   tok_is(&t[i + 1], "(")) {
+            i = skip_group(t, i + 1, n, "(", ")");
+        } else if (t[i].kind == TOK_IDENT && tok_in(&t[i], prefix_words)) {
+            i++;
+            if (i < n && tok_is(&t[i - 1], "pub") && tok_is(&t[i], "("))
+                i = skip_group(t, i, n, "(", ")");
+            else if (i < n && t[i].kind == TOK_STRING)
+                i++;
+        } else {
+            break;
+        }
     }
+    return i;
+}
 
-    hr_change_type_t result = HR_CHANGE_BODY_ONLY;
+static void name_before(const token_t* t, int k, char* name) {
+    name[0] = 0;
+    if (k >= 0 && tok_is(&t[k], ">")) {
+        int depth = 0;
+        for (; k >= 0; k--) {
+            if (tok_is(&t[k], ">")) depth++;
+            else if (tok_is(&t[k], "<") && --depth == 0) { k--; break; }
+        }
+    }
+    if (k < 0) return;
+    if (t[k].kind == TOK_PUNCT && k > 0 && tok_is(&t[k - 1], "operator")) {
+        name_append(name, "operator", 8);
+        name_append(name, t[k].text, t[k].len);
+        k--;
+    } else if (t[k].kind == TOK_IDENT && !tok_in(&t[k], not_names)) {
+        name_append(name, t[k].text, t[k].len);
+        if (k > 0 && tok_is(&t[k - 1], "~")) {
+            char tmp[HR_DIFFER_MAX_NAME] = "~";
+            name_append(tmp, name, strlen(name));
+            strcpy(name, tmp);
+            k--;
+        }
+    } else {
+        return;
+    }
+    while (k >= 2 && tok_is(&t[k - 1], "::") && t[k - 2].kind == TOK_IDENT) {
+        char tmp[HR_DIFFER_MAX_NAME] = {0};
+        name_append(tmp, t[k - 2].text, t[k - 2].len);
+        name_append(tmp, "::", 2);
+        name_append(tmp, name, strlen(name));
+        strcpy(name, tmp);
+        k -= 2;
+    }
+}
+
+static int function_name(const token_t* t, int start, int n, char* name) {
+    int paren = 0;
+    for (int i = start; i < n; i++) {
+        if (paren == 0 && (tok_is(&t[i], "{") || tok_is(&t[i], "="))) return 0;
+        if (tok_is(&t[i], "(")) {
+            if (paren++ == 0) {
+                name_before(t, i - 1, name);
+                if (name[0]) return 1;
+            }
+        } else if (tok_is(&t[i], ")")) {
+            paren--;
+        }
+    }
+    return 0;
+}
+
+static void directive_name(const token_t* t, int n, char* name) {
+    name_append(name, "#", 1);
+    if (n < 2) return;
+    name_append(name, t[1].text, t[1].len);
+    int single = tok_is(&t[1], "define") || tok_is(&t[1], "undef") ||
+                 tok_is(&t[1], "ifdef") || tok_is(&t[1], "ifndef");
+    for (int i = 2; i < n && t[i].kind != TOK_DIRECTIVE_END; i++) {
+        name_append(name, " ", i == 2);
+        name_append(name, t[i].text, t[i].len);
+        if (single) break;
+    }
+}
+
+static int type_name(const token_t* t, int i, int n, char* name) {
+    const token_t* kw = &t[i];
+    if (tok_is(kw, "typedef")) {
+        for (int k = i + 1; k + 2 < n; k++) {
+            if (tok_is(&t[k], "(") && tok_is(&t[k + 1], "*") && t[k + 2].kind == TOK_IDENT) {
+                name_append(name, t[k + 2].text, t[k + 2].len);
+                return 1;
+            }
+        }
+        int depth = 0;
+        for (int k = n - 1; k > i; k--) {
+            if (tok_is(&t[k], "]") || tok_is(&t[k], "}")) depth++;
+            else if (tok_is(&t[k], "[") || tok_is(&t[k], "{")) depth--;
+            else if (depth == 0 && t[k].kind == TOK_IDENT) {
+                name_append(name, t[k].text, t[k].len);
+                return 1;
+            }
+        }
+        return 1;
+    }
+    if (tok_is(kw, "using")) {
+        if (i + 2 < n && t[i + 1].kind == TOK_IDENT && tok_is(&t[i + 2], "=")) {
+            name_append(name, t[i + 1].text, t[i + 1].len);
+            return 1;
+        }
+        return 0;
+    }
+    if (tok_is(kw, "struct") || tok_is(kw, "union") || tok_is(kw, "enum") || tok_is(kw, "class")) {
+        int k = i + 1;
+        if (k < n && (tok_is(&t[k], "class") || tok_is(&t[k], "struct"))) k++;
+        while (k < n && (tok_is(&t[k], "__attribute__") || tok_is(&t[k], "alignas"))) {
+            k++;
+            if (k < n && tok_is(&t[k], "(")) k = skip_group(t, k, n, "(", ")");
+        }
+        if (k < n && t[k].kind == TOK_IDENT) {
+            name_append(name, t[k].text, t[k].len);
+            k++;
+        }
+        if (k < n && (tok_is(&t[k], "{") || tok_is(&t[k], ":") || tok_is(&t[k], ";") ||
+                      tok_is(&t[k], "(") || tok_is(&t[k], "<") || tok_is(&t[k], "final")))
+            return 1;
+        name[0] = 0;
+        return 0;
+    }
+    if (tok_is(kw, "type") || tok_is(kw, "trait") || tok_is(kw, "interface") || tok_is(kw, "concept")) {
+        if (i + 1 < n && t[i + 1].kind == TOK_IDENT) {
+            name_append(name, t[i + 1].text, t[i + 1].len);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void decl_name(const token_t* t, int i, int n, char* name) {
+    int depth = 0;
+    for (int k = i; k + 1 < n; k++) {
+        if (tok_is(&t[k], "(") || tok_is(&t[k], "[") || tok_is(&t[k], "{")) depth++;
+        else if (tok_is(&t[k], ")") || tok_is(&t[k], "]") || tok_is(&t[k], "}")) depth--;
+        if (depth != 0 || t[k].kind != TOK_IDENT || tok_in(&t[k], not_names)) continue;
+        const token_t* next = &t[k + 1];
+        if (tok_is(next, "=") || tok_is(next, ";") || tok_is(next, "[") || tok_is(next, "(") ||
+            tok_is(next, ":") || tok_is(next, ",")) {
+            name_append(name, t[k].text, t[k].len);
+            return;
+        }
+    }
+    for (int k = i; k < n && k < i + 3; k++) {
+        name_append(name, " ", k > i);
+        name_append(name, t[k].text, t[k].len);
+    }
+}
+
+static int item_is_type_definition(const token_t* t, int i, int n) {
+    for (int k = i; k + 1 < n; k++) {
+        if (tok_is(&t[k], "{") || tok_is(&t[k], "(")) return 0;
+        if (tok_is(&t[k], "=") && (tok_is(&t[k + 1], "struct") || tok_is(&t[k + 1], "enum") ||
+                                   tok_is(&t[k + 1], "union") || tok_is(&t[k + 1], "opaque")))
+            return 1;
+    }
+    return 0;
+}
+
+static void add_item(segmenter_t* s, hr_item_kind_t kind, const char* name,
+                     uint64_t hash, uint64_t signature) {
+    hr_snapshot_t* snap = s->snap;
+    if (snap->count >= snap->capacity) {
+        int capacity = snap->capacity ? snap->capacity * 2 : 32;
+        hr_source_item_t* items = realloc(snap->items, sizeof(hr_source_item_t) * (size_t)capacity);
+        if (!items) return;
+        snap->items    = items;
+        snap->capacity = capacity;
+    }
+    char full[HR_DIFFER_MAX_NAME * 2] = {0};
+    for (int i = 0; i < s->scope_depth; i++) {
+        if (!s->scope[i][0]) continue;
+        strncat(full, s->scope[i], sizeof(full) - strlen(full) - 1);
+        strncat(full, "::", sizeof(full) - strlen(full) - 1);
+    }
+    strncat(full, name, sizeof(full) - strlen(full) - 1);
+
+    int occurrence = 0;
+    for (int i = 0; i < snap->count; i++)
+        if (snap->items[i].kind == kind && strcmp(snap->items[i].name, full) == 0) occurrence++;
+
+    char* copy = strdup(full);
+    if (!copy) return;
+    hr_source_item_t* item = &snap->items[snap->count++];
+    item->kind       = kind;
+    item->name       = copy;
+    item->occurrence = occurrence;
+    item->hash       = hash;
+    item->signature  = signature;
+}
+
+static void flush_item(segmenter_t* s) {
+    const token_t* t = s->toks;
+    int n = s->count;
+    s->count  = 0;
+    s->closed = 0;
+    if (n == 0 || (n == 1 && tok_is(&t[0], ";"))) return;
+
+    hr_hasher_t h, sig;
+    hr_hash_init(&h, HR_DIFFER_SEED);
+    hr_hash_init(&sig, HR_DIFFER_SEED);
+    int in_sig = 1;
+    for (int i = 0; i < n; i++) {
+        hash_token(&h, &t[i]);
+        if (in_sig && tok_is(&t[i], "{")) in_sig = 0;
+        if (in_sig) hash_token(&sig, &t[i]);
+    }
+    uint64_t hash      = hr_hash_final(&h).lo;
+    uint64_t signature = hr_hash_final(&sig).lo;
+
+    char name[HR_DIFFER_MAX_NAME] = {0};
+    if (t[0].kind == TOK_DIRECTIVE) {
+        directive_name(t, n, name);
+        add_item(s, HR_ITEM_DIRECTIVE, name, hash, signature);
+        return;
+    }
+    int i = skip_prefix(t, n);
+    if (i >= n) i = 0;
+    if (type_name(t, i, n, name) || item_is_type_definition(t, i, n)) {
+        if (!name[0]) decl_name(t, i, n, name);
+        add_item(s, HR_ITEM_TYPE, name, hash, signature);
+    } else if (tok_is(&t[n - 1], "}") && function_name(t, i, n, name)) {
+        add_item(s, HR_ITEM_FUNCTION, name, hash, signature);
+    } else {
+        name[0] = 0;
+        decl_name(t, i, n, name);
+        add_item(s, HR_ITEM_DECL, name, hash, signature);
+    }
+}
+
+static void push_token(segmenter_t* s, const token_t* t) {
+    if (s->count >= s->capacity) {
+        int capacity = s->capacity ? s->capacity * 2 : 256;
+        token_t* toks = realloc(s->toks, sizeof(token_t) * (size_t)capacity);
+        if (!toks) return;
+        s->toks     = toks;
+        s->capacity = capacity;
+    }
+    s->toks[s->count++] = *t;
+}
+
+/* extern "C" { ... }, namespace x { ... } and mod x { ... } only scope the
+   items they contain; their braces do not make one big item. */
+static int opens_scope(segmenter_t* s, char* name) {
+    const token_t* t = s->toks;
+    int n = s->count;
+    int i = 0;
+    while (i < n && (tok_is(&t[i], "pub") || tok_is(&t[i], "inline") || tok_is(&t[i], "export"))) i++;
+    name[0] = 0;
+    if (n - i == 2 && tok_is(&t[i], "extern") && t[i + 1].kind == TOK_STRING) return 1;
+    if (i < n && tok_is(&t[i], "impl")) {
+        int k = i + 1;
+        if (k < n && tok_is(&t[k], "<")) k = skip_group(t, k, n, "<", ">");
+        for (int f = k; f < n; f++)
+            if (tok_is(&t[f], "for")) k = f + 1;
+        while (k + 2 < n && t[k].kind == TOK_IDENT && tok_is(&t[k + 1], "::")) k += 2;
+        if (k < n && t[k].kind == TOK_IDENT) name_append(name, t[k].text, t[k].len);
+        return 1;
+    }
+    if (i < n && (tok_is(&t[i], "namespace") || tok_is(&t[i], "mod"))) {
+        for (int k = i + 1; k < n; k++) {
+            if (t[k].kind != TOK_IDENT && !tok_is(&t[k], "::")) return 0;
+            name_append(name, t[k].text, t[k].len);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+static void feed(segmenter_t* s, const token_t* t) {
+    hash_token(&s->file, t);
+
+    if (s->closed) {
+        s->closed = 0;
+        if (tok_is(t, ";")) {
+            push_token(s, t);
+            flush_item(s);
+            return;
+        }
+        if (!(s->count > 0 && tok_is(&s->toks[0], "typedef")))
+            flush_item(s);
+    }
+
+    int top = s->brace == 0 && s->paren == 0 && s->bracket == 0;
+    if (top && s->go_semicolons && t->newline && s->count > 0) {
+        const token_t* last = &s->toks[s->count - 1];
+        if (last->kind == TOK_IDENT || last->kind == TOK_NUMBER || last->kind == TOK_STRING ||
+            tok_is(last, ")") || tok_is(last, "]"))
+            flush_item(s);
+    }
+
+    if (t->kind == TOK_DIRECTIVE && top && s->count > 0 && s->toks[0].kind != TOK_DIRECTIVE)
+        flush_item(s);
+
+    if (top && tok_is(t, "{") && s->scope_depth < HR_DIFFER_MAX_SCOPE) {
+        char name[HR_DIFFER_MAX_NAME];
+        if (opens_scope(s, name)) {
+            strcpy(s->scope[s->scope_depth++], name);
+            s->count = 0;
+            return;
+        }
+    }
+    if (top && tok_is(t, "}") && s->scope_depth > 0) {
+        flush_item(s);
+        s->scope_depth--;
+        return;
+    }
+
+    push_token(s, t);
+    if (t->kind == TOK_DIRECTIVE_END) {
+        if (s->toks[0].kind == TOK_DIRECTIVE) flush_item(s);
+        return;
+    }
+    if      (tok_is(t, "{")) s->brace++;
+    else if (tok_is(t, "(")) s->paren++;
+    else if (tok_is(t, "[")) s->bracket++;
+    else if (tok_is(t, ")") && s->paren > 0)   s->paren--;
+    else if (tok_is(t, "]") && s->bracket > 0) s->bracket--;
+    else if (tok_is(t, "}") && s->brace > 0) {
+        if (--s->brace == 0 && s->paren == 0 && s->bracket == 0) s->closed = 1;
+    } else if (tok_is(t, ";") && top) {
+        flush_item(s);
+    }
+}
+
+int hr_differ_snapshot(const char* path, hr_snapshot_t* out) {
+    memset(out, 0, sizeof(*out));
+    size_t size = 0;
+    char*  text = read_file(path, &size);
+    if (!text) return 0;
+
+    const char* ext = strrchr(path, '.');
+    segmenter_t s;
+    memset(&s, 0, sizeof(s));
+    s.snap          = out;
+    s.go_semicolons = ext && strcmp(ext, ".go") == 0;
+    hr_hash_init(&s.file, HR_DIFFER_SEED);
+
+    lexer_t lx = { text, text + size, 1, 0, s.go_semicolons };
+    token_t t;
+    while (lex_next(&lx, &t))
+        feed(&s, &t);
+    flush_item(&s);
+
+    out->hash = hr_hash_final(&s.file).lo;
+    free(s.toks);
+    free(text);
+    return 1;
+}
+
+void hr_differ_snapshot_free(hr_snapshot_t* snap) {
+    if (!snap) return;
+    for (int i = 0; i < snap->count; i++) free(snap->items[i].name);
+    free(snap->items);
+    memset(snap, 0, sizeof(*snap));
+}
+
+static const hr_source_item_t* find_item(const hr_snapshot_t* snap, const hr_source_item_t* item) {
+    for (int i = 0; i < snap->count; i++) {
+        const hr_source_item_t* other = &snap->items[i];
+        if (other->kind == item->kind && other->occurrence == item->occurrence &&
+            strcmp(other->name, item->name) == 0)
+            return other;
+    }
+    return NULL;
+}
+
+static void list_add(char*** list, int* count, const char* name) {
+    for (int i = 0; i < *count; i++)
+        if (strcmp((*list)[i], name) == 0) return;
+    char** grown = realloc(*list, sizeof(char*) * (size_t)(*count + 1));
+    if (!grown) return;
+    *list = grown;
+    if ((grown[*count] = strdup(name)) != NULL) (*count)++;
+}
+
+static void note_change(hr_change_set_t* out, const hr_source_item_t* item, hr_change_type_t type) {
+    if (type > out->type) out->type = type;
+    if (item->kind == HR_ITEM_FUNCTION) list_add(&out->functions, &out->function_count, item->name);
+    else                                list_add(&out->types, &out->type_count, item->name);
+}
+
+hr_change_type_t hr_differ_compare(const hr_snapshot_t* old_snap, const hr_snapshot_t* new_snap,
+                                   hr_change_set_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (old_snap->hash == new_snap->hash) return out->type = HR_CHANGE_NONE;
+
+    for (int i = 0; i < new_snap->count; i++) {
+        const hr_source_item_t* now = &new_snap->items[i];
+        const hr_source_item_t* was = find_item(old_snap, now);
+        if (was && was->hash == now->hash) continue;
+        if (now->kind == HR_ITEM_FUNCTION)
+            note_change(out, now, was && was->signature == now->signature ? HR_CHANGE_BODY_ONLY
+                                                                          : HR_CHANGE_SIGNATURE);
+        else
+            note_change(out, now, HR_CHANGE_STRUCT);
+    }
+    for (int i = 0; i < old_snap->count; i++) {
+        const hr_source_item_t* was = &old_snap->items[i];
+        if (find_item(new_snap, was)) continue;
+        note_change(out, was, was->kind == HR_ITEM_FUNCTION ? HR_CHANGE_SIGNATURE : HR_CHANGE_STRUCT);
+    }
+    if (out->type == HR_CHANGE_NONE) out->type = HR_CHANGE_BODY_ONLY;
+    return out->type;
+}
+
+void hr_change_set_free(hr_change_set_t* changes) {
+    if (!changes) return;
+    for (int i = 0; i < changes->function_count; i++) free(changes->functions[i]);
+    for (int i = 0; i < changes->type_count; i++) free(changes->types[i]);
+    free(changes->functions);
+    free(changes->types);
+    memset(changes, 0, sizeof(*changes));
+}
+
+hr_differ_t* hr_differ_create(void) {
+    return calloc(1, sizeof(hr_differ_t));
+}
+
+void hr_differ_destroy(hr_differ_t* differ) {
+    if (!differ) return;
+    for (int i = 0; i < differ->count; i++) {
+        free(differ->files[i].path);
+        hr_differ_snapshot_free(&differ->files[i].snap);
+    }
+    free(differ->files);
+    free(differ->index);
+    free(differ);
+}
+
+/* index holds 1 + the position in files, 0 for an empty slot. */
+static int* probe(const hr_differ_t* differ, const char* path, uint64_t hash) {
+    uint32_t mask = (uint32_t)differ->index_capacity - 1;
+    for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1) & mask) {
+        int* slot = &differ->index[i];
+        if (!*slot) return slot;
+        const hr_tracked_t* file = &differ->files[*slot - 1];
+        if (file->hash == hash && strcmp(file->path, path) == 0) return slot;
+    }
+}
+
+static int grow_index(hr_differ_t* differ) {
+    int capacity = differ->index_capacity ? differ->index_capacity * 2 : HR_DIFFER_INDEX_MIN;
+    int* index = calloc((size_t)capacity, sizeof(int));
+    if (!index) return 0;
+    free(differ->index);
+    differ->index          = index;
+    differ->index_capacity = capacity;
+    for (int i = 0; i < differ->count; i++) {
+        const hr_tracked_t* file = &differ->files[i];
+        *probe(differ, file->path, file->hash) = i + 1;
+    }
+    return 1;
+}
+
+static hr_tracked_t* find_path(hr_differ_t* differ, const char* path) {
+    if (!differ->index_capacity) return NULL;
+    int slot = *probe(differ, path, hr_symbols_hash(path));
+    return slot ? &differ->files[slot - 1] : NULL;
+}
+
+static hr_tracked_t* add_path(hr_differ_t* differ, const char* path) {
+    if ((differ->count + 1) * 4 > differ->index_capacity * 3 && !grow_index(differ))
+        return NULL;
+    if (differ->count >= differ->capacity) {
+        int capacity = differ->capacity ? differ->capacity * 2 : 16;
+        hr_tracked_t* files = realloc(differ->files, sizeof(hr_tracked_t) * (size_t)capacity);
+        if (!files) return NULL;
+        differ->files    = files;
+        differ->capacity = capacity;
+    }
+    char* copy = strdup(path);
+    if (!copy) return NULL;
+    hr_tracked_t* file = &differ->files[differ->count++];
+    memset(file, 0, sizeof(*file));
+    file->path = copy;
+    file->hash = hr_symbols_hash(path);
+    *probe(differ, path, file->hash) = differ->count;
+    return file;
+}
+
+static void store(hr_tracked_t* file, hr_snapshot_t* snap, int64_t size, int64_t mtime) {
+    hr_differ_snapshot_free(&file->snap);
+    file->snap  = *snap;
+    file->size  = size;
+    file->mtime = mtime;
+}
+
+/* Makes the file's current content the baseline. A path that is already
+   tracked is kept as is, since hr_differ_update moves its baseline on every
+   event; refresh re-reads it anyway (unless untouched since the last
+   snapshot) for loads that bypassed the events, such as a rescan. */
+void hr_differ_track(hr_differ_t* differ, const char* path, int refresh) {
+    if (!differ) return;
+    hr_tracked_t* file = find_path(differ, path);
+    if (file && !refresh) return;
+    int64_t size  = hr_platform_file_size(path);
+    int64_t mtime = hr_platform_file_mtime(path);
+    if (file && file->size == size && file->mtime == mtime) return;
+    hr_snapshot_t snap;
+    if (!hr_differ_snapshot(path, &snap)) return;
+    if (!file) file = add_path(differ, path);
+    if (file) store(file, &snap, size, mtime);
+    else      hr_differ_snapshot_free(&snap);
+}
 
-    if (has_header_change(new_src) && !has_header_change(old_src))
-        result = HR_CHANGE_STRUCT;
-    else if (has_signature_change(old_src, new_src))
-        result = HR_CHANGE_SIGNATURE;
+hr_change_type_t hr_differ_update(hr_differ_t* differ, const char* path, hr_change_set_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->type = HR_CHANGE_FULL;
+    if (!differ) return HR_CHANGE_FULL;
+    int64_t size  = hr_platform_file_size(path);
+    int64_t mtime = hr_platform_file_mtime(path);
+    hr_snapshot_t snap;
+    if (!hr_differ_snapshot(path, &snap)) return HR_CHANGE_FULL;
 
-    free(old_src);
-    free(new_src);
-    return result;
+    hr_tracked_t* file = find_path(differ, path);
+    hr_change_type_t type = HR_CHANGE_FULL;
+    if (file) type = hr_differ_compare(&file->snap, &snap, out);
+    else      file = add_path(differ, path);
+    if (file) store(file, &snap, size, mtime);
+    else      hr_differ_snapshot_free(&snap);
+    return type;
 }
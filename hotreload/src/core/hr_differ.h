@@ -1,6 +1,8 @@
 #ifndef HR_DIFFER_H
 #define HR_DIFFER_H
 
+#include <stdint.h>
+
 typedef enum {
     HR_CHANGE_NONE = 0,
     HR_CHANGE_BODY_ONLY,
@@ -9,6 +11,49 @@ typedef enum {
     HR_CHANGE_FULL
 } hr_change_type_t;
 
-hr_change_type_t hr_differ_analyze(const char* old_path, const char* new_path);
+typedef enum {
+    HR_ITEM_FUNCTION = 0,
+    HR_ITEM_TYPE,
+    HR_ITEM_DECL,
+    HR_ITEM_DIRECTIVE
+} hr_item_kind_t;
+
+typedef struct {
+    hr_item_kind_t kind;
+    char*          name;
+    int            occurrence;
+    uint64_t       hash;
+    uint64_t       signature;
+} hr_source_item_t;
+
+typedef struct {
+    hr_source_item_t* items;
+    int               count;
+    int               capacity;
+    uint64_t          hash;
+} hr_snapshot_t;
+
+/* Functions lists changed, added and removed functions; types lists every
+   other top-level definition that changed: types, globals and directives. */
+typedef struct {
+    hr_change_type_t type;
+    char**           functions;
+    int              function_count;
+    char**           types;
+    int              type_count;
+} hr_change_set_t;
+
+typedef struct hr_differ hr_differ_t;
+
+int              hr_differ_snapshot(const char* path, hr_snapshot_t* out);
+void             hr_differ_snapshot_free(hr_snapshot_t* snap);
+hr_change_type_t hr_differ_compare(const hr_snapshot_t* old_snap, const hr_snapshot_t* new_snap,
+                                   hr_change_set_t* out);
+void             hr_change_set_free(hr_change_set_t* changes);
+
+hr_differ_t*     hr_differ_create(void);
+void             hr_differ_destroy(hr_differ_t* differ);
+void             hr_differ_track(hr_differ_t* differ, const char* path, int refresh);
+hr_change_type_t hr_differ_update(hr_differ_t* differ, const char* path, hr_change_set_t* out);
 
 #endif
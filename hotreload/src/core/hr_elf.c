@@ -0,0 +1,146 @@
+#include "hr_elf.h"
+#include <string.h>
+
+#define EI_CLASS      4
+#define EI_DATA       5
+#define ELFCLASS32    1
+#define ELFCLASS64    2
+#define SHT_DYNSYM    11
+#define SHN_UNDEF     0
+#define STB_GLOBAL    1
+#define STB_WEAK      2
+#define STT_OBJECT    1
+#define STT_FUNC      2
+#define STT_GNU_IFUNC 10
+
+static uint16_t rd16(const unsigned char* p) { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+static uint32_t rd32(const unsigned char* p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+static uint64_t rd64(const unsigned char* p) { uint64_t v; memcpy(&v, p, sizeof(v)); return v; }
+
+static int host_data_encoding(void) {
+    const uint16_t probe = 1;
+    return *(const unsigned char*)&probe == 1 ? 1 : 2;
+}
+
+typedef struct {
+    uint32_t type;
+    uint64_t flags;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t link;
+    uint64_t entsize;
+} section_t;
+
+static int read_section(const hr_elf_t* elf, uint64_t shoff, uint16_t shentsize,
+                        uint64_t index, section_t* out) {
+    uint64_t off = shoff + index * shentsize;
+    if (off + shentsize > elf->size) return 0;
+    const unsigned char* sh = elf->image + off;
+    if (elf->is64) {
+        out->type    = rd32(sh + 4);
+        out->flags   = rd64(sh + 8);
+        out->offset  = rd64(sh + 24);
+        out->size    = rd64(sh + 32);
+        out->link    = rd32(sh + 40);
+        out->entsize = rd64(sh + 56);
+    } else {
+        out->type    = rd32(sh + 4);
+        out->flags   = rd32(sh + 8);
+        out->offset  = rd32(sh + 16);
+        out->size    = rd32(sh + 20);
+        out->link    = rd32(sh + 24);
+        out->entsize = rd32(sh + 36);
+    }
+    if (out->type == HR_ELF_SHT_NOBITS) return 1;
+    return out->offset <= elf->size && out->size <= elf->size - out->offset;
+}
+
+int hr_elf_open(hr_elf_t* elf, const void* image, size_t size) {
+    memset(elf, 0, sizeof(*elf));
+    const unsigned char* p = (const unsigned char*)image;
+    if (size < 52 || memcmp(p, "\177ELF", 4) != 0) return 0;
+    if (p[EI_DATA] != host_data_encoding()) return 0;
+    if (p[EI_CLASS] != ELFCLASS32 && p[EI_CLASS] != ELFCLASS64) return 0;
+
+    elf->image = p;
+    elf->size  = size;
+    elf->is64  = p[EI_CLASS] == ELFCLASS64;
+    if (elf->is64 && size < 64) return 0;
+
+    uint64_t shoff     = elf->is64 ? rd64(p + 40) : rd32(p + 32);
+    uint16_t shentsize = rd16(p + (elf->is64 ? 58 : 46));
+    uint64_t shnum     = rd16(p + (elf->is64 ? 60 : 48));
+    if (shoff == 0 || shentsize < (elf->is64 ? 64 : 40)) return 0;
+
+    section_t sec;
+    if (shnum == 0) {
+        if (!read_section(elf, shoff, shentsize, 0, &sec)) return 0;
+        shnum = sec.size;
+    }
+    elf->shoff     = shoff;
+    elf->shentsize = shentsize;
+    elf->shnum     = (size_t)shnum;
+
+    for (uint64_t i = 0; i < shnum; i++) {
+        if (!read_section(elf, shoff, shentsize, i, &sec) || sec.type != SHT_DYNSYM) continue;
+        section_t str;
+        if (sec.entsize < (elf->is64 ? 24u : 16u) || sec.link >= shnum ||
+            !read_section(elf, shoff, shentsize, sec.link, &str))
+            return 0;
+        elf->syms        = p + sec.offset;
+        elf->sym_entsize = (size_t)sec.entsize;
+        elf->sym_count   = (size_t)(sec.size / sec.entsize);
+        elf->strtab      = (const char*)(p + str.offset);
+        elf->strtab_size = (size_t)str.size;
+        return 1;
+    }
+    return 0;
+}
+
+int hr_elf_symbol(const hr_elf_t* elf, size_t index, hr_elf_symbol_t* out) {
+    if (index >= elf->sym_count) return 0;
+    const unsigned char* s = elf->syms + index * elf->sym_entsize;
+    uint32_t name;
+    unsigned char info;
+    uint16_t shndx;
+    if (elf->is64) {
+        name       = rd32(s);
+        info       = s[4];
+        shndx      = rd16(s + 6);
+        out->value = rd64(s + 8);
+        out->size  = rd64(s + 16);
+    } else {
+        name       = rd32(s);
+        out->value = rd32(s + 4);
+        out->size  = rd32(s + 8);
+        info       = s[12];
+        shndx      = rd16(s + 14);
+    }
+    if (shndx == SHN_UNDEF || name == 0 || name >= elf->strtab_size) return 0;
+    if (!memchr(elf->strtab + name, 0, elf->strtab_size - name)) return 0;
+
+    unsigned bind = info >> 4;
+    unsigned type = info & 0xf;
+    if (bind != STB_GLOBAL && bind != STB_WEAK) return 0;
+
+    out->name = elf->strtab + name;
+    out->weak = bind == STB_WEAK;
+    switch (type) {
+    case STT_FUNC:      out->type = HR_ELF_FUNC;   break;
+    case STT_GNU_IFUNC: out->type = HR_ELF_IFUNC;  break;
+    case STT_OBJECT:    out->type = HR_ELF_OBJECT; break;
+    default:            out->type = HR_ELF_OTHER;  break;
+    }
+    return 1;
+}
+
+int hr_elf_section(const hr_elf_t* elf, size_t index, hr_elf_section_t* out) {
+    section_t sec;
+    if (index >= elf->shnum || !read_section(elf, elf->shoff, elf->shentsize, index, &sec))
+        return 0;
+    out->type  = sec.type;
+    out->flags = sec.flags;
+    out->size  = sec.size;
+    out->data  = sec.type == HR_ELF_SHT_NOBITS ? NULL : elf->image + sec.offset;
+    return 1;
+}
@@ -0,0 +1,51 @@
+#ifndef HR_ELF_H
+#define HR_ELF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    HR_ELF_OTHER = 0,
+    HR_ELF_FUNC,
+    HR_ELF_IFUNC,
+    HR_ELF_OBJECT
+} hr_elf_type_t;
+
+#define HR_ELF_SHT_NOBITS     8
+#define HR_ELF_SHF_ALLOC      0x2
+#define HR_ELF_SHF_EXECINSTR  0x4
+
+typedef struct {
+    const char*   name;
+    uint64_t      value;
+    uint64_t      size;
+    hr_elf_type_t type;
+    int           weak;
+} hr_elf_symbol_t;
+
+typedef struct {
+    uint32_t    type;
+    uint64_t    flags;
+    const void* data;
+    uint64_t    size;
+} hr_elf_section_t;
+
+typedef struct {
+    const unsigned char* image;
+    size_t               size;
+    int                  is64;
+    const unsigned char* syms;
+    size_t               sym_count;
+    size_t               sym_entsize;
+    const char*          strtab;
+    size_t               strtab_size;
+    uint64_t             shoff;
+    uint16_t             shentsize;
+    size_t               shnum;
+} hr_elf_t;
+
+int hr_elf_open(hr_elf_t* elf, const void* image, size_t size);
+int hr_elf_symbol(const hr_elf_t* elf, size_t index, hr_elf_symbol_t* out);
+int hr_elf_section(const hr_elf_t* elf, size_t index, hr_elf_section_t* out);
+
+#endif
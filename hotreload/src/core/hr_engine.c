@@ -3,38 +3,70 @@
 #include "hr_differ.h"
 #include "hr_loader.h"
 #include "hr_patcher.h"
+#include "hr_got.h"
+#include "hr_reclaim.h"
 #include "hr_symbols.h"
+#include "hr_slots.h"
+#include "hr_builder.h"
+#include "hr_pathmap.h"
+#include "hr_toolchain.h"
 #include "../adapters/hr_adapter.h"
 #include "../platform/hr_platform.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 
 #define HR_VERSION_STR "1.0.0"
-#define HR_MAX_MODULES 64
 
 struct hr_module {
+    hr_context_t*       ctx;
+    int                 id;
     hr_loaded_module_t* loaded;
-    hr_patch_t          patches[HR_MAX_SYMBOLS];
-    int                 patch_count;
     char                cache_path[4096];
+    hr_slot_list_t      slots;
+    uint64_t            use_count;
+    uint64_t            last_use;
+    char                watch_path[4096];
 };
 
 struct hr_context {
-    hr_watcher_t*    watcher;
-    hr_adapter_t*    adapter;
-    hr_config_t      config;
-    char             watch_dir[4096];
-    char             build_dir[4096];
-    hr_module_t*     modules[HR_MAX_MODULES];
-    int              module_count;
-    int              dirty;
-    char             dirty_path[4096];
+    hr_watcher_t*        watcher;
+    hr_builder_t*        builder;
+    hr_loader_stores_t   stores;
+    hr_toolchain_probe_t toolchain;
+    hr_redirect_mode_t   redirect;
+    hr_reclaimer_t*      reclaimer;
+    volatile long        thread_budget;
+    hr_adapter_t*        adapter;
+    hr_config_t          config;
+    char                 watch_dir[4096];
+    char                 build_dir[4096];
+    hr_module_t*         modules[HR_MAX_MODULES];
+    int                  module_count;
+    hr_module_t*         by_id[HR_MAX_MODULES];
+    hr_pathmap_t*        paths;
+    hr_differ_t*         differ;
+    hr_modset_t          dirty;
+    hr_modset_t          restat;
+    int                  rescan;
+    uint64_t             tick;
+    hr_stats_t           stats;
 };
 
 static hr_log_level_t g_log_level = HR_LOG_INFO;
 
+#if defined(_MSC_VER)
+#define HR_RELAXED_INC(p)      ((*(p))++)
+#define HR_RELAXED_STORE(p, v) (*(volatile uint64_t*)(p) = (v))
+#define HR_RELAXED_LOAD(p)     (*(volatile uint64_t*)(p))
+#else
+#define HR_RELAXED_INC(p)      __atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
+#define HR_RELAXED_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define HR_RELAXED_LOAD(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#endif
+
 static void hr_log(hr_log_level_t level, const char* fmt, ...) {
     if (level > g_log_level) return;
     const char* prefix[] = {"", "[ERROR]", "[WARN]", "[INFO]", "[DEBUG]"};
@@ -46,13 +78,77 @@ static void hr_log(hr_log_level_t level, const char* fmt, ...) {
     fprintf(stderr, "\n");
 }
 
-#include <stdarg.h>
-
 static void on_file_changed(const char* path, void* userdata) {
     hr_context_t* ctx = (hr_context_t*)userdata;
-    strncpy(ctx->dirty_path, path, sizeof(ctx->dirty_path)-1);
-    ctx->dirty = 1;
+    if (!path) {
+        hr_log(HR_LOG_WARN, "watch events dropped, rescanning modules");
+        ctx->rescan = 1;
+        return;
+    }
+    const hr_modset_t* mods = hr_pathmap_find(ctx->paths, path);
+    if (!mods || !hr_modset_any(mods)) {
+        hr_log(HR_LOG_DEBUG, "ignored change: %s", path);
+        return;
+    }
+    hr_change_set_t changes;
+    hr_change_type_t type = hr_differ_update(ctx->differ, path, &changes);
+    if (type == HR_CHANGE_NONE) {
+        hr_log(HR_LOG_INFO, "file changed: %s (no code change, reload skipped)", path);
+        ctx->stats.reloads_skipped++;
+        return;
+    }
     hr_log(HR_LOG_INFO, "file changed: %s", path);
+    if (g_log_level >= HR_LOG_DEBUG) {
+        static const char* names[] = {"none", "body", "signature", "struct", "full"};
+        hr_log(HR_LOG_DEBUG, "%s change: %d functions, %d other definitions",
+               names[type], changes.function_count, changes.type_count);
+        for (int i = 0; i < changes.function_count; i++)
+            hr_log(HR_LOG_DEBUG, "  function %s", changes.functions[i]);
+        for (int i = 0; i < changes.type_count; i++)
+            hr_log(HR_LOG_DEBUG, "  definition %s", changes.types[i]);
+    }
+    hr_change_set_free(&changes);
+    hr_modset_or(&ctx->dirty, mods);
+}
+
+static void* resolve_slot(void* userdata, const char* name) {
+    return hr_loader_get_sym((hr_loaded_module_t*)userdata, name);
+}
+
+static void account_compile(hr_context_t* ctx, uint64_t wall_ns, uint64_t cpu_ns) {
+    if (wall_ns == 0) return;
+    ctx->stats.compiles++;
+    ctx->stats.compile_wall_us += wall_ns / 1000;
+    ctx->stats.compile_cpu_us  += cpu_ns / 1000;
+}
+
+/* refresh re-reads baselines the watcher did not keep current: on load
+   (edits made while unloaded are ignored) and after a rescan. */
+static void register_paths(hr_context_t* ctx, hr_module_t* mod, int refresh) {
+    const hr_dep_list_t* deps = &mod->loaded->deps;
+    hr_pathmap_remove_id(ctx->paths, mod->id);
+    hr_pathmap_add(ctx->paths, mod->watch_path, mod->id);
+    hr_differ_track(ctx->differ, mod->watch_path, refresh);
+    for (int i = 0; i < deps->count; i++) {
+        hr_pathmap_add(ctx->paths, deps->paths[i], mod->id);
+        hr_differ_track(ctx->differ, deps->paths[i], refresh);
+    }
+    hr_log(HR_LOG_DEBUG, "%s depends on %d files", mod->watch_path, deps->count);
+}
+
+static hr_redirect_mode_t redirect_mode(const hr_config_t* config) {
+    if (!config->enable_patching) return HR_REDIRECT_OFF;
+    const char* wanted = config->patch_strategy ? config->patch_strategy : "auto";
+    int trampoline = hr_patcher_supported();
+    int got        = hr_got_supported();
+    if (strcmp(wanted, "trampoline") == 0 && trampoline) return HR_REDIRECT_TRAMPOLINE;
+    if (strcmp(wanted, "got") == 0 && got)               return HR_REDIRECT_GOT;
+    if (strcmp(wanted, "auto") != 0)
+        hr_log(HR_LOG_WARN, "patch strategy '%s' unavailable, using auto", wanted);
+    if (trampoline && got) return HR_REDIRECT_AUTO;
+    if (trampoline)        return HR_REDIRECT_TRAMPOLINE;
+    if (got)               return HR_REDIRECT_GOT;
+    return HR_REDIRECT_OFF;
 }
 
 hr_config_t hr_default_config(void) {
@@ -62,6 +158,18 @@ hr_config_t hr_default_config(void) {
     cfg.build_dir       = ".hotreload_build";
     cfg.poll_interval_ms = 50;
     cfg.enable_patching  = 1;
+    cfg.async_compile    = 1;
+    cfg.max_jobs         = 0;
+    cfg.event_queue_size = 64;
+    cfg.debounce_ms      = 30;
+    cfg.watch_recursive  = 1;
+    cfg.watch_filter     = "*.c;*.h;*.cc;*.cpp;*.cxx;*.hh;*.hpp;*.hxx;*.inl;*.rs;*.zig;*.go";
+    cfg.enable_cache     = 1;
+    cfg.cache_max_bytes  = 512ULL << 20;
+    cfg.enable_pch       = 1;
+    cfg.linker           = "auto";
+    cfg.patch_strategy   = "auto";
+    cfg.max_generations  = 16;
     return cfg;
 }
 
@@ -79,35 +187,105 @@ hr_context_t* hr_init(const char* watch_dir, hr_lang_t lang, const hr_config_t*
 
     hr_platform_mkdir(ctx->build_dir);
 
+    hr_toolchain_probe(ctx->build_dir, &ctx->toolchain);
+    if (!hr_toolchain_apply(&ctx->toolchain, ctx->config.linker))
+        hr_log(HR_LOG_WARN, "linker '%s' unavailable, using the system linker", ctx->config.linker);
+    hr_log(HR_LOG_DEBUG, "toolchain probe | %.1f ms%s", (double)ctx->toolchain.probe_ns / 1e6,
+           ctx->toolchain.from_cache ? " | cached" : "");
+    for (int i = 0; i < ctx->toolchain.count; i++) {
+        const hr_toolchain_t* tc = &ctx->toolchain.langs[i];
+        if (tc->available)
+            hr_log(HR_LOG_DEBUG, "toolchain %s | linker=%s | %s", tc->compiler, tc->linker, tc->version);
+    }
+
+    ctx->redirect = redirect_mode(&ctx->config);
+
+    ctx->paths = hr_pathmap_create();
+    if (!ctx->paths) { free(ctx); return NULL; }
+    ctx->differ = hr_differ_create();
+
     if (lang == HR_LANG_AUTO) {
         ctx->adapter = NULL;
     } else {
-        ctx->adapter = hr_adapter_get(lang);
+        ctx->adapter = hr_toolchain_adapter(&ctx->toolchain, hr_adapter_get(lang));
     }
 
-    ctx->watcher = hr_watcher_create(watch_dir, on_file_changed, ctx);
+    hr_watcher_options_t wopts;
+    wopts.queue_size       = ctx->config.event_queue_size;
+    wopts.debounce_ms      = ctx->config.debounce_ms;
+    wopts.poll_interval_ms = ctx->config.poll_interval_ms;
+    wopts.recursive        = ctx->config.watch_recursive;
+    wopts.filter           = ctx->config.watch_filter;
+    wopts.exclude_dir      = ctx->build_dir;
+    ctx->watcher = hr_watcher_create(watch_dir, &wopts, on_file_changed, ctx);
     if (!ctx->watcher) {
         hr_log(HR_LOG_ERROR, "failed to create watcher for: %s", watch_dir);
+        hr_pathmap_destroy(ctx->paths);
+        hr_differ_destroy(ctx->differ);
         free(ctx);
         return NULL;
     }
 
+    ctx->reclaimer = hr_reclaim_create();
+    if (!ctx->reclaimer)
+        hr_log(HR_LOG_WARN, "no reclaim thread, old generations are unmapped immediately");
+    ctx->stores.reclaimer = ctx->reclaimer;
+
+    if (ctx->config.enable_cache) {
+        char dir[4096 + 8];
+        snprintf(dir, sizeof(dir), "%s/cache", ctx->build_dir);
+        ctx->stores.cache = hr_cache_open(dir, hr_platform_lib_ext(), ctx->config.cache_max_bytes);
+        snprintf(dir, sizeof(dir), "%s/obj", ctx->build_dir);
+        ctx->stores.objects = hr_cache_open(dir, ".o", ctx->config.cache_max_bytes);
+        if (!ctx->stores.cache || !ctx->stores.objects)
+            hr_log(HR_LOG_WARN, "compile cache unavailable in %s", ctx->build_dir);
+    }
+
+    if (ctx->config.enable_pch) {
+        ctx->stores.pch = hr_pch_open(ctx->build_dir);
+        if (!ctx->stores.pch)
+            hr_log(HR_LOG_WARN, "precompiled headers unavailable in %s", ctx->build_dir);
+    }
+
+    if (ctx->config.async_compile) {
+        ctx->builder = hr_builder_create(ctx->build_dir, ctx->config.compiler_flags,
+                                         ctx->config.max_jobs);
+        if (!ctx->builder)
+            hr_log(HR_LOG_WARN, "background compiler unavailable, reloading synchronously");
+        else
+            hr_log(HR_LOG_DEBUG, "background compiler | jobs=%d", hr_builder_jobs(ctx->builder));
+    }
+    ctx->thread_budget = ctx->builder ? hr_builder_jobs(ctx->builder)
+                       : ctx->config.max_jobs > 0 ? ctx->config.max_jobs : hr_platform_cpu_count();
+    ctx->stores.thread_budget = &ctx->thread_budget;
+
+    hr_watcher_stats_t ws;
+    hr_watcher_stats(ctx->watcher, &ws);
     hr_log(HR_LOG_INFO, "initialized | platform=%s | dir=%s", hr_platform_name(), watch_dir);
+    hr_log(HR_LOG_DEBUG, "watching %d directories | %zu bytes | %.1f ms",
+           ws.directories, ws.memory_bytes, (double)ws.startup_ns / 1e6);
     return ctx;
 }
 
 void hr_shutdown(hr_context_t* ctx) {
     if (!ctx) return;
-    for (int i = 0; i < ctx->module_count; i++) {
-        hr_unload(ctx, ctx->modules[i]);
-    }
+    hr_builder_destroy(ctx->builder);
+    ctx->builder = NULL;
+    while (ctx->module_count > 0)
+        hr_unload(ctx, ctx->modules[0]);
+    hr_reclaim_destroy(ctx->reclaimer);
+    hr_cache_close(ctx->stores.cache);
+    hr_cache_close(ctx->stores.objects);
+    hr_pch_close(ctx->stores.pch);
     hr_watcher_destroy(ctx->watcher);
+    hr_pathmap_destroy(ctx->paths);
+    hr_differ_destroy(ctx->differ);
     free(ctx);
     hr_log(HR_LOG_INFO, "shutdown complete");
 }
 
-hr_module_t* hr_load(hr_context_t* ctx, const char* source_path) {
-    if (!ctx || !source_path) return NULL;
+static hr_module_t* load_module(hr_context_t* ctx, const char* name,
+                                const char* const* sources, int count) {
     if (ctx->module_count >= HR_MAX_MODULES) {
         hr_log(HR_LOG_ERROR, "max modules reached");
         return NULL;
@@ -115,101 +293,366 @@ hr_module_t* hr_load(hr_context_t* ctx, const char* source_path) {
 
     hr_adapter_t* adapter = ctx->adapter;
     if (!adapter) {
-        adapter = hr_adapter_detect(source_path);
+        adapter = hr_toolchain_adapter(&ctx->toolchain,
+                                       hr_adapter_detect(sources ? sources[0] : name));
         if (!adapter) {
-            hr_log(HR_LOG_ERROR, "cannot detect language for: %s", source_path);
+            hr_log(HR_LOG_ERROR, "cannot detect language for: %s", sources ? sources[0] : name);
             return NULL;
         }
     }
+    if (sources && (!adapter->compile_object || !adapter->link)) {
+        hr_log(HR_LOG_ERROR, "%s modules must be built from a single source", adapter->name);
+        return NULL;
+    }
 
-    hr_log(HR_LOG_INFO, "loading %s [%s]", source_path, adapter->name);
+    if (sources) hr_log(HR_LOG_INFO, "loading %s [%s] | %d sources", name, adapter->name, count);
+    else         hr_log(HR_LOG_INFO, "loading %s [%s]", name, adapter->name);
 
-    hr_loaded_module_t* loaded = hr_loader_open(source_path, ctx->build_dir,
-                                                adapter, ctx->config.compiler_flags);
+    hr_loaded_module_t* loaded = sources
+        ? hr_loader_open_units(name, sources, count, ctx->build_dir, adapter,
+                               ctx->config.compiler_flags, &ctx->stores)
+        : hr_loader_open(name, ctx->build_dir, adapter, ctx->config.compiler_flags, &ctx->stores);
     if (!loaded) {
-        hr_log(HR_LOG_ERROR, "failed to load: %s", source_path);
+        hr_log(HR_LOG_ERROR, "failed to load: %s", name);
         return NULL;
     }
 
+    account_compile(ctx, loaded->compile_wall_ns, loaded->compile_cpu_ns);
+
     hr_module_t* mod = calloc(1, sizeof(hr_module_t));
     if (!mod) { hr_loader_close(loaded); return NULL; }
+    mod->ctx    = ctx;
     mod->loaded = loaded;
+    hr_slots_init(&mod->slots);
+
+    mod->id = 0;
+    while (ctx->by_id[mod->id]) mod->id++;
+    const char* watch = sources ? loaded->sources[0] : name;
+    if (!hr_platform_realpath(watch, mod->watch_path, sizeof(mod->watch_path)))
+        strncpy(mod->watch_path, watch, sizeof(mod->watch_path)-1);
+    register_paths(ctx, mod, 1);
+    ctx->by_id[mod->id] = mod;
 
     ctx->modules[ctx->module_count++] = mod;
     hr_log(HR_LOG_INFO, "loaded OK | symbols=%d", loaded->symbols.count);
+    hr_log(HR_LOG_DEBUG, "symbol table: %zu bytes", hr_symbols_memory(&loaded->symbols));
     return mod;
 }
 
+hr_module_t* hr_load(hr_context_t* ctx, const char* source_path) {
+    if (!ctx || !source_path) return NULL;
+    return load_module(ctx, source_path, NULL, 0);
+}
+
+hr_module_t* hr_load_sources(hr_context_t* ctx, const char* name,
+                             const char* const* sources, int count) {
+    if (!ctx || !name || !sources || count <= 0) return NULL;
+    for (int i = 0; i < count; i++)
+        if (!sources[i]) return NULL;
+    return load_module(ctx, name, sources, count);
+}
+
+static void close_loaded(void* loaded) {
+    hr_loader_close((hr_loaded_module_t*)loaded);
+}
+
+static void free_unloaded(void* module) {
+    hr_module_t* mod = (hr_module_t*)module;
+    hr_slots_free(&mod->slots);
+    free(mod);
+}
+
+/* Code that other threads may still be running is released by the
+   reclaimer once all of them have been quiescent. */
+static void retire(hr_context_t* ctx, hr_reclaim_fn fn, void* item) {
+    if (ctx->reclaimer) hr_reclaim_retire(ctx->reclaimer, fn, item);
+    else                fn(item);
+}
+
+/* Keeps at most max_generations old generations mapped as redirection
+   sources, none without patching; older ones are retired. */
+static void retire_generations(hr_context_t* ctx, hr_loaded_module_t* loaded) {
+    int keep = ctx->redirect == HR_REDIRECT_OFF ? 0 : ctx->config.max_generations;
+    if (keep == 0 && ctx->redirect != HR_REDIRECT_OFF) return;
+    while (loaded->retained_count > keep) {
+        hr_generation_t* gen = hr_loader_detach_oldest(loaded);
+        if (!gen) break;
+        hr_log(HR_LOG_DEBUG, "retired generation %u of %s", gen->generation, loaded->src_path);
+        retire(ctx, hr_loader_free_generation, gen);
+    }
+}
+
 void hr_unload(hr_context_t* ctx, hr_module_t* mod) {
     if (!ctx || !mod) return;
-    for (int i = 0; i < mod->patch_count; i++)
-        hr_patcher_revert(&mod->patches[i]);
-    hr_loader_close(mod->loaded);
+    hr_builder_cancel(ctx->builder, mod);
+    retire(ctx, close_loaded, mod->loaded);
+    hr_pathmap_remove_id(ctx->paths, mod->id);
+    hr_modset_clear(&ctx->dirty, mod->id);
+    hr_modset_clear(&ctx->restat, mod->id);
+    ctx->by_id[mod->id] = NULL;
     for (int i = 0; i < ctx->module_count; i++) {
         if (ctx->modules[i] == mod) {
             ctx->modules[i] = ctx->modules[--ctx->module_count];
             break;
         }
     }
-    free(mod);
+    /* Other threads may still be reading a bound slot or the module. */
+    retire(ctx, free_unloaded, mod);
 }
 
-hr_result_t hr_reload_module(hr_context_t* ctx, hr_module_t* mod) {
-    if (!ctx || !mod) return HR_ERR_INVALID;
-    hr_log(HR_LOG_INFO, "reloading: %s", mod->loaded->src_path);
-
-    for (int i = 0; i < mod->patch_count; i++)
-        hr_patcher_revert(&mod->patches[i]);
-    mod->patch_count = 0;
+static void log_redirects(const hr_generation_t* gen) {
+    if (g_log_level < HR_LOG_DEBUG) return;
+    for (int i = 0; i < gen->symbols.count; i++) {
+        if (gen->redirects[i] == HR_REDIRECT_OFF) continue;
+        const char* how = gen->redirects[i] == HR_REDIRECT_GOT ? "got"
+                        : gen->patches[i].length == (int)hr_patcher_near_size() ? "near trampoline"
+                        : "trampoline";
+        hr_log(HR_LOG_DEBUG, "  %s -> %s", gen->symbols.entries[i].name, how);
+    }
+}
 
-    hr_result_t res = hr_loader_reload(mod->loaded, ctx->build_dir,
-                                       ctx->config.compiler_flags,
-                                       ctx->config.save_state,
-                                       ctx->config.restore_state);
+static hr_result_t finish_reload(hr_context_t* ctx, hr_module_t* mod, hr_result_t res, int changed) {
+    if (res == HR_OK) {
+        register_paths(ctx, mod, hr_modset_test(&ctx->restat, mod->id));
+        hr_modset_clear(&ctx->restat, mod->id);
+    }
+    if (res == HR_OK && changed == 0) {
+        ctx->stats.reloads_unchanged++;
+        hr_log(HR_LOG_INFO, "reload skipped | machine code unchanged");
+        return res;
+    }
+    hr_slots_rebind(&mod->slots, resolve_slot, mod->loaded);
+    if (res == HR_OK && mod->loaded->retained_count > 0) {
+        const hr_loaded_module_t* loaded = mod->loaded;
+        ctx->stats.functions_patched += (uint64_t)(loaded->patched_count + loaded->got_count);
+        ctx->stats.functions_via_got += (uint64_t)loaded->got_count;
+        ctx->stats.got_slots_patched += (uint64_t)loaded->got_slots;
+        if (loaded->patched_count > 0) {
+            ctx->stats.patch_pause_ns = loaded->pause_ns;
+            if (loaded->pause_ns > ctx->stats.patch_pause_max_ns)
+                ctx->stats.patch_pause_max_ns = loaded->pause_ns;
+        }
+        ctx->stats.patch_protect_calls += (uint64_t)loaded->protect_calls;
+        ctx->stats.patch_ns = loaded->redirect_ns;
+        hr_log(HR_LOG_DEBUG, "redirected %d functions across %d old generations in %.1f us | "
+               "trampoline=%d (%d near, %d threads paused %.1f us) | got=%d (%d slots) | %d protection changes",
+               loaded->patched_count + loaded->got_count, loaded->retained_count,
+               (double)loaded->redirect_ns / 1e3,
+               loaded->patched_count, loaded->near_count, loaded->threads_paused,
+               (double)loaded->pause_ns / 1e3,
+               loaded->got_count, loaded->got_slots, loaded->protect_calls);
+        log_redirects(&loaded->retained[loaded->retained_count - 1]);
+    }
+    if (res == HR_OK) ctx->stats.reloads_ok++;
+    else              ctx->stats.reloads_failed++;
+    if (res == HR_OK && changed > 0) ctx->stats.functions_changed += (uint64_t)changed;
     if (ctx->config.on_reload)
         ctx->config.on_reload(mod->loaded->src_path, res);
     if (res == HR_OK)
-        hr_log(HR_LOG_INFO, "reload OK | symbols=%d", mod->loaded->symbols.count);
+        hr_log(HR_LOG_INFO, "reload OK | symbols=%d | changed=%d",
+               mod->loaded->symbols.count, changed > 0 ? changed : 0);
     else
         hr_log(HR_LOG_ERROR, "reload failed: %s", hr_result_str(res));
     return res;
 }
 
+/* Swaps a finished build in, unless it is byte-identical to the live
+   generation. Returns the number of exported functions that changed, 0 when
+   the build was dropped, or -1 when the commit failed. */
+static int commit_build(hr_context_t* ctx, hr_module_t* mod, hr_build_t* build, hr_result_t* res) {
+    int identical = 0;
+    int changed = hr_loader_diff(mod->loaded, build, &identical);
+    if (identical) {
+        hr_loader_keep(mod->loaded, build);
+        return 0;
+    }
+    *res = hr_loader_commit(mod->loaded, build, ctx->redirect,
+                            ctx->config.save_state, ctx->config.restore_state);
+    if (*res != HR_OK) return -1;
+    retire_generations(ctx, mod->loaded);
+    if (changed == 0)
+        hr_log(HR_LOG_DEBUG, "code changed outside exported functions");
+    return changed > 0 ? changed : -1;
+}
+
+hr_result_t hr_reload_module(hr_context_t* ctx, hr_module_t* mod) {
+    if (!ctx || !mod) return HR_ERR_INVALID;
+    hr_log(HR_LOG_INFO, "reloading: %s", mod->loaded->src_path);
+
+    hr_builder_cancel(ctx->builder, mod);
+
+    hr_build_t build;
+    hr_result_t res = hr_loader_build(mod->loaded, ctx->build_dir, ctx->config.compiler_flags,
+                                      ++mod->loaded->next_generation, &mod->loaded->deps,
+                                      NULL, &build);
+    account_compile(ctx, build.compile_wall_ns, build.compile_cpu_ns);
+    int changed = -1;
+    if (res == HR_OK)
+        changed = commit_build(ctx, mod, &build, &res);
+    return finish_reload(ctx, mod, res, changed);
+}
+
+static uint64_t module_priority(hr_context_t* ctx, hr_module_t* mod) {
+    uint64_t last_use = mod->slots.count > 0 ? ctx->tick : HR_RELAXED_LOAD(&mod->last_use);
+    uint64_t uses     = HR_RELAXED_LOAD(&mod->use_count) + (uint64_t)mod->slots.count;
+    if (uses > 0xFFFFFF) uses = 0xFFFFFF;
+    return (last_use << 24) | uses;
+}
+
+static hr_result_t schedule_reload(hr_context_t* ctx, hr_module_t* mod) {
+    if (!ctx->builder)
+        return hr_reload_module(ctx, mod);
+    hr_builder_submit(ctx->builder, mod->loaded, mod, module_priority(ctx, mod));
+    hr_log(HR_LOG_INFO, "compiling in background: %s", mod->loaded->src_path);
+    return HR_OK;
+}
+
+static hr_result_t swap_finished(hr_context_t* ctx) {
+    hr_result_t result = HR_OK;
+    hr_build_job_t* job;
+    while ((job = hr_builder_take_done(ctx->builder)) != NULL) {
+        hr_module_t* mod = (hr_module_t*)job->owner;
+        account_compile(ctx, job->build.compile_wall_ns, job->build.compile_cpu_ns);
+        if (job->cancel || job->generation <= mod->loaded->generation) {
+            hr_log(HR_LOG_DEBUG, "dropped stale build g%u: %s", job->generation, mod->loaded->src_path);
+            ctx->stats.builds_cancelled++;
+            hr_builder_job_free(job);
+            continue;
+        }
+
+        hr_result_t res = job->result;
+        int changed = -1;
+        if (res == HR_OK) {
+            changed = commit_build(ctx, mod, &job->build, &res);
+            if (job->build.from_cache)
+                hr_log(HR_LOG_DEBUG, "g%u restored from cache in %.1f ms", job->generation,
+                       (double)(job->finish_ns - job->submit_ns) / 1e6);
+            else
+                hr_log(HR_LOG_DEBUG, "g%u built in %.1f ms (compiler %.1f ms wall, %.1f ms cpu)",
+                       job->generation, (double)(job->finish_ns - job->submit_ns) / 1e6,
+                       (double)job->build.compile_wall_ns / 1e6, (double)job->build.compile_cpu_ns / 1e6);
+            if (mod->loaded->source_count > 0)
+                hr_log(HR_LOG_DEBUG, "g%u units | compiled=%d | reused=%d", job->generation,
+                       job->build.units_compiled, job->build.units_reused);
+        }
+        hr_builder_job_free(job);
+        if (finish_reload(ctx, mod, res, changed) != HR_OK) result = res;
+    }
+    return result;
+}
+
+int hr_thread_register(void) {
+    return hr_reclaim_register();
+}
+
+void hr_thread_unregister(void) {
+    hr_reclaim_unregister();
+}
+
+void hr_quiescent(void) {
+    hr_reclaim_quiescent();
+}
+
 hr_result_t hr_poll(hr_context_t* ctx) {
     if (!ctx) return HR_ERR_INVALID;
+    hr_reclaim_quiescent();
+    HR_RELAXED_STORE(&ctx->tick, ctx->tick + 1);
     hr_watcher_poll(ctx->watcher);
 
-    if (!ctx->dirty) return HR_OK;
-    ctx->dirty = 0;
-
     hr_result_t result = HR_OK;
-    for (int i = 0; i < ctx->module_count; i++) {
-        hr_module_t* mod = ctx->modules[i];
-        if (strstr(ctx->dirty_path, mod->loaded->src_path) ||
-            strstr(mod->loaded->src_path, ctx->dirty_path)) {
-            result = hr_reload_module(ctx, mod);
+    if (ctx->rescan) {
+        ctx->rescan = 0;
+        for (int i = 0; i < ctx->module_count; i++) {
+            hr_module_t* mod = ctx->modules[i];
+            if (hr_platform_file_mtime(mod->loaded->src_path) > mod->loaded->last_mtime)
+                hr_modset_set(&ctx->dirty, mod->id);
+            const hr_dep_list_t* deps = &mod->loaded->deps;
+            for (int d = 0; d < deps->count && !hr_modset_test(&ctx->dirty, mod->id); d++)
+                if (hr_platform_file_mtime(deps->paths[d]) > mod->loaded->last_mtime)
+                    hr_modset_set(&ctx->dirty, mod->id);
+            if (hr_modset_test(&ctx->dirty, mod->id)) hr_modset_set(&ctx->restat, mod->id);
         }
     }
 
-    if (result == HR_OK && ctx->module_count > 0) {
-        hr_result_t any = HR_OK;
-        for (int i = 0; i < ctx->module_count; i++) {
-            int64_t mtime = hr_platform_file_mtime(ctx->modules[i]->loaded->src_path);
-            if (mtime > ctx->modules[i]->loaded->last_mtime) {
-                any = hr_reload_module(ctx, ctx->modules[i]);
-                if (any != HR_OK) result = any;
-            }
+    if (hr_modset_any(&ctx->dirty)) {
+        hr_modset_t dirty = ctx->dirty;
+        memset(&ctx->dirty, 0, sizeof(ctx->dirty));
+        for (int id = hr_modset_next(&dirty, 0); id >= 0; id = hr_modset_next(&dirty, id + 1)) {
+            if (!ctx->by_id[id]) continue;
+            hr_result_t res = schedule_reload(ctx, ctx->by_id[id]);
+            if (res != HR_OK) result = res;
         }
     }
 
+    if (ctx->builder) {
+        hr_result_t swapped = swap_finished(ctx);
+        if (swapped != HR_OK) result = swapped;
+    }
     return result;
 }
 
+void hr_get_stats(hr_context_t* ctx, hr_stats_t* out) {
+    if (!ctx || !out) return;
+    hr_watcher_stats_t ws;
+    hr_watcher_stats(ctx->watcher, &ws);
+    *out = ctx->stats;
+    out->events_received    = ws.received;
+    out->events_coalesced   = ws.coalesced;
+    out->events_dropped     = ws.dropped;
+    out->events_filtered    = ws.filtered;
+    out->watch_directories  = ws.directories;
+    out->watch_memory_bytes = ws.memory_bytes;
+    out->watch_startup_us   = ws.startup_ns / 1000;
+
+    out->generations_retained = 0;
+    for (int i = 0; i < ctx->module_count; i++)
+        out->generations_retained += (uint64_t)ctx->modules[i]->loaded->retained_count;
+    if (ctx->reclaimer) {
+        out->generations_pending   = (uint64_t)hr_reclaim_pending(ctx->reclaimer);
+        out->generations_reclaimed = hr_reclaim_released(ctx->reclaimer);
+    }
+
+    hr_cache_stats_t cs;
+    hr_cache_get_stats(ctx->stores.cache, &cs);
+    out->cache_hits         = cs.hits;
+    out->cache_misses       = cs.misses;
+    out->cache_evictions    = cs.evictions;
+    out->cache_shared       = cs.shared;
+    out->cache_bytes        = cs.bytes;
+
+    hr_pch_stats_t ps;
+    hr_pch_get_stats(ctx->stores.pch, &ps);
+    out->pch_hits           = ps.hits;
+    out->pch_misses         = ps.misses;
+    out->pch_failures       = ps.failures;
+
+    hr_cache_get_stats(ctx->stores.objects, &cs);
+    out->object_hits        = cs.hits;
+    out->object_misses      = cs.misses;
+}
+
+hr_result_t hr_get_toolchain(hr_context_t* ctx, hr_lang_t lang, hr_toolchain_t* out) {
+    if (!ctx || !out) return HR_ERR_INVALID;
+    const hr_toolchain_t* tc = hr_toolchain_find(&ctx->toolchain, lang);
+    if (!tc) return HR_ERR_INVALID;
+    *out = *tc;
+    return HR_OK;
+}
+
 void* hr_get_fn(hr_module_t* mod, const char* name) {
     if (!mod || !name) return NULL;
+    HR_RELAXED_INC(&mod->use_count);
+    HR_RELAXED_STORE(&mod->last_use, HR_RELAXED_LOAD(&mod->ctx->tick));
     return hr_loader_get_sym(mod->loaded, name);
 }
 
+hr_fn_slot_t* hr_bind(hr_module_t* mod, const char* name) {
+    if (!mod || !name) return NULL;
+    hr_fn_slot_t* slot = hr_slots_find(&mod->slots, name);
+    if (slot) return slot;
+    return hr_slots_bind(&mod->slots, name, hr_loader_get_sym(mod->loaded, name));
+}
+
 const char* hr_result_str(hr_result_t result) {
     switch (result) {
         case HR_OK:           return "OK";
@@ -0,0 +1,146 @@
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+#include "hr_got.h"
+#include "../platform/hr_platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define HR_GOT_ELF 1
+#include <link.h>
+#include <elf.h>
+
+#if defined(__x86_64__)
+#define HR_R_JUMP_SLOT R_X86_64_JUMP_SLOT
+#define HR_R_GLOB_DAT  R_X86_64_GLOB_DAT
+#else
+#define HR_R_JUMP_SLOT R_AARCH64_JUMP_SLOT
+#define HR_R_GLOB_DAT  R_AARCH64_GLOB_DAT
+#endif
+#endif
+
+int hr_got_supported(void) {
+#ifdef HR_GOT_ELF
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+#ifdef HR_GOT_ELF
+typedef struct {
+    const hr_got_redirect_t* map;
+    int                      count;
+    int                      rewritten;
+    int                      protect_calls;
+    uintptr_t                relro_start;
+    uintptr_t                relro_end;
+    int                      relro_state;
+} got_scan_t;
+
+static int compare_from(const void* a, const void* b) {
+    uintptr_t x = ((const hr_got_redirect_t*)a)->from;
+    uintptr_t y = ((const hr_got_redirect_t*)b)->from;
+    return x < y ? -1 : x > y;
+}
+
+static const hr_got_redirect_t* find_from(const got_scan_t* scan, uintptr_t addr) {
+    hr_got_redirect_t key = { addr, 0 };
+    return bsearch(&key, scan->map, (size_t)scan->count, sizeof(key), compare_from);
+}
+
+/* glibc relocates the pointers in .dynamic in place on most targets but not
+   all; an address below the load base is still an offset. */
+static uintptr_t dyn_ptr(uintptr_t base, ElfW(Addr) ptr) {
+    return base && ptr < base ? base + ptr : (uintptr_t)ptr;
+}
+
+/* The object's RELRO range is made writable on the first slot found in it
+   and stays so until the whole object has been scanned. relro_state is 1
+   while writable, -1 once that failed. */
+static int open_relro(got_scan_t* scan, uintptr_t slot) {
+    if (slot < scan->relro_start || slot >= scan->relro_end) return 1;
+    if (scan->relro_state) return scan->relro_state > 0;
+    scan->protect_calls++;
+    int ok = hr_platform_protect_data((void*)scan->relro_start, scan->relro_end - scan->relro_start, 1);
+    scan->relro_state = ok ? 1 : -1;
+    return ok;
+}
+
+static void close_relro(got_scan_t* scan) {
+    if (scan->relro_state > 0) {
+        hr_platform_protect_data((void*)scan->relro_start, scan->relro_end - scan->relro_start, 0);
+        scan->protect_calls++;
+    }
+    scan->relro_state = 0;
+}
+
+static void rewrite_relocs(got_scan_t* scan, uintptr_t base, const ElfW(Rela)* rela, size_t size) {
+    size_t count = size / sizeof(ElfW(Rela));
+    for (size_t i = 0; i < count; i++) {
+        unsigned long type = (unsigned long)ELF64_R_TYPE(rela[i].r_info);
+        if (type != HR_R_JUMP_SLOT && type != HR_R_GLOB_DAT) continue;
+        uintptr_t* slot = (uintptr_t*)(base + rela[i].r_offset);
+        const hr_got_redirect_t* r = find_from(scan, __atomic_load_n(slot, __ATOMIC_RELAXED));
+        if (!r || !open_relro(scan, (uintptr_t)slot)) continue;
+        __atomic_store_n(slot, r->to, __ATOMIC_RELEASE);
+        scan->rewritten++;
+    }
+}
+
+static int scan_object(struct dl_phdr_info* info, size_t size, void* userdata) {
+    (void)size;
+    got_scan_t* scan = (got_scan_t*)userdata;
+    uintptr_t base = (uintptr_t)info->dlpi_addr;
+    const ElfW(Dyn)* dyn = NULL;
+    scan->relro_start = scan->relro_end = 0;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* ph = &info->dlpi_phdr[i];
+        if (ph->p_type == PT_DYNAMIC) dyn = (const ElfW(Dyn)*)(base + ph->p_vaddr);
+        if (ph->p_type == PT_GNU_RELRO) {
+            /* The loader only protects whole pages; the tail shares a
+               page with writable data and must stay writable. */
+            uintptr_t page = (uintptr_t)hr_platform_page_size();
+            scan->relro_start = base + ph->p_vaddr;
+            scan->relro_end   = (scan->relro_start + ph->p_memsz) & ~(page - 1);
+        }
+    }
+    if (!dyn) return 0;
+
+    uintptr_t jmprel = 0, rela = 0;
+    size_t    jmprel_size = 0, rela_size = 0;
+    int       plt_is_rela = 1;
+    for (; dyn->d_tag != DT_NULL; dyn++) {
+        switch (dyn->d_tag) {
+        case DT_JMPREL:   jmprel      = dyn_ptr(base, dyn->d_un.d_ptr); break;
+        case DT_PLTRELSZ: jmprel_size = (size_t)dyn->d_un.d_val;        break;
+        case DT_PLTREL:   plt_is_rela = dyn->d_un.d_val == DT_RELA;     break;
+        case DT_RELA:     rela        = dyn_ptr(base, dyn->d_un.d_ptr); break;
+        case DT_RELASZ:   rela_size   = (size_t)dyn->d_un.d_val;        break;
+        default: break;
+        }
+    }
+    if (jmprel && plt_is_rela)
+        rewrite_relocs(scan, base, (const ElfW(Rela)*)jmprel, jmprel_size);
+    if (rela)
+        rewrite_relocs(scan, base, (const ElfW(Rela)*)rela, rela_size);
+    close_relro(scan);
+    return 0;
+}
+#endif
+
+int hr_got_redirect(hr_got_redirect_t* map, int count, int* protect_calls) {
+    if (protect_calls) *protect_calls = 0;
+#ifdef HR_GOT_ELF
+    if (count <= 0) return 0;
+    qsort(map, (size_t)count, sizeof(*map), compare_from);
+    got_scan_t scan = { map, count, 0, 0, 0, 0, 0 };
+    dl_iterate_phdr(scan_object, &scan);
+    if (protect_calls) *protect_calls = scan.protect_calls;
+    return scan.rewritten;
+#else
+    (void)map; (void)count;
+    return -1;
+#endif
+}
@@ -0,0 +1,21 @@
+#ifndef HR_GOT_H
+#define HR_GOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uintptr_t from;
+    uintptr_t to;
+} hr_got_redirect_t;
+
+/* Rewrites every resolved GOT slot (PLT jump slots and address-taken
+   imports) of every loaded object that holds one of the `from` addresses.
+   Code pages are never written. Returns the number of slots rewritten, or
+   -1 when the platform has no ELF dynamic loader. Sorts `map` by `from`.
+   Each object's RELRO range is reprotected at most twice; the number of
+   protection changes is stored in `protect_calls` when not NULL. */
+int hr_got_redirect(hr_got_redirect_t* map, int count, int* protect_calls);
+int hr_got_supported(void);
+
+#endif
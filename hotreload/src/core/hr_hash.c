@@ -0,0 +1,135 @@
+#include "hr_hash.h"
+#include <stdio.h>
+#include <string.h>
+
+#define C1 0x87c37b91114253d5ULL
+#define C2 0x4cf5ad432745937fULL
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+static inline uint64_t load64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static void mix_block(hr_hasher_t* h, const unsigned char* block) {
+    uint64_t k1 = load64(block);
+    uint64_t k2 = load64(block + 8);
+
+    k1 *= C1; k1 = rotl64(k1, 31); k1 *= C2; h->h1 ^= k1;
+    h->h1 = rotl64(h->h1, 27); h->h1 += h->h2; h->h1 = h->h1 * 5 + 0x52dce729;
+
+    k2 *= C2; k2 = rotl64(k2, 33); k2 *= C1; h->h2 ^= k2;
+    h->h2 = rotl64(h->h2, 31); h->h2 += h->h1; h->h2 = h->h2 * 5 + 0x38495ab5;
+}
+
+void hr_hash_init(hr_hasher_t* h, uint64_t seed) {
+    h->h1       = seed;
+    h->h2       = seed;
+    h->length   = 0;
+    h->tail_len = 0;
+}
+
+void hr_hash_update(hr_hasher_t* h, const void* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    h->length += len;
+
+    if (h->tail_len > 0) {
+        size_t take = 16 - h->tail_len;
+        if (take > len) take = len;
+        memcpy(h->tail + h->tail_len, p, take);
+        h->tail_len += take;
+        p   += take;
+        len -= take;
+        if (h->tail_len < 16) return;
+        mix_block(h, h->tail);
+        h->tail_len = 0;
+    }
+    for (; len >= 16; p += 16, len -= 16)
+        mix_block(h, p);
+    memcpy(h->tail, p, len);
+    h->tail_len = len;
+}
+
+void hr_hash_str(hr_hasher_t* h, const char* s) {
+    hr_hash_update(h, s ? s : "", (s ? strlen(s) : 0) + 1);
+}
+
+void hr_hash_u64(hr_hasher_t* h, uint64_t v) {
+    unsigned char buf[8];
+    for (int i = 0; i < 8; i++) buf[i] = (unsigned char)(v >> (8 * i));
+    hr_hash_update(h, buf, sizeof(buf));
+}
+
+hr_hash128_t hr_hash_final(const hr_hasher_t* h) {
+    uint64_t h1 = h->h1, h2 = h->h2;
+    uint64_t k1 = 0, k2 = 0;
+    const unsigned char* tail = h->tail;
+
+    for (size_t i = h->tail_len; i > 8; i--) k2 = (k2 << 8) | tail[i-1];
+    if (h->tail_len > 8) {
+        k2 *= C2; k2 = rotl64(k2, 33); k2 *= C1; h2 ^= k2;
+    }
+    for (size_t i = h->tail_len < 8 ? h->tail_len : 8; i > 0; i--) k1 = (k1 << 8) | tail[i-1];
+    if (h->tail_len > 0) {
+        k1 *= C1; k1 = rotl64(k1, 31); k1 *= C2; h1 ^= k1;
+    }
+
+    h1 ^= h->length; h2 ^= h->length;
+    h1 += h2; h2 += h1;
+    h1 = fmix64(h1); h2 = fmix64(h2);
+    h1 += h2; h2 += h1;
+
+    hr_hash128_t out = { h1, h2 };
+    return out;
+}
+
+int hr_hash_file(const char* path, hr_hash128_t* out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    hr_hasher_t h;
+    hr_hash_init(&h, 0);
+    unsigned char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        hr_hash_update(&h, buf, n);
+    int ok = !ferror(f);
+    fclose(f);
+    *out = hr_hash_final(&h);
+    return ok;
+}
+
+int hr_hash_equal(hr_hash128_t a, hr_hash128_t b) {
+    return a.lo == b.lo && a.hi == b.hi;
+}
+
+void hr_hash_hex(hr_hash128_t hash, char out[33]) {
+    snprintf(out, 33, "%016llx%016llx", (unsigned long long)hash.hi, (unsigned long long)hash.lo);
+}
+
+int hr_hash_parse(const char* hex, hr_hash128_t* out) {
+    uint64_t parts[2] = {0, 0};
+    for (int i = 0; i < 32; i++) {
+        char c = hex[i];
+        int  v;
+        if      (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else return 0;
+        parts[i / 16] = (parts[i / 16] << 4) | (uint64_t)v;
+    }
+    out->hi = parts[0];
+    out->lo = parts[1];
+    return 1;
+}
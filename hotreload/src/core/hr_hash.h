@@ -0,0 +1,30 @@
+#ifndef HR_HASH_H
+#define HR_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t lo;
+    uint64_t hi;
+} hr_hash128_t;
+
+typedef struct {
+    uint64_t      h1;
+    uint64_t      h2;
+    uint64_t      length;
+    unsigned char tail[16];
+    size_t        tail_len;
+} hr_hasher_t;
+
+void         hr_hash_init(hr_hasher_t* h, uint64_t seed);
+void         hr_hash_update(hr_hasher_t* h, const void* data, size_t len);
+void         hr_hash_str(hr_hasher_t* h, const char* s);
+void         hr_hash_u64(hr_hasher_t* h, uint64_t v);
+hr_hash128_t hr_hash_final(const hr_hasher_t* h);
+int          hr_hash_file(const char* path, hr_hash128_t* out);
+int          hr_hash_equal(hr_hash128_t a, hr_hash128_t b);
+void         hr_hash_hex(hr_hash128_t hash, char out[33]);
+int          hr_hash_parse(const char* hex, hr_hash128_t* out);
+
+#endif
@@ -1,112 +1,993 @@
 #include "hr_loader.h"
+#include "hr_elf.h"
+#include "hr_hash.h"
+#include "hr_got.h"
+#include "../adapters/hr_demangle.h"
 #include "../platform/hr_platform.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static void populate_symbols(hr_loaded_module_t* m) {
-    char sym_buf[65536] = {0};
-    if (!m->adapter->list_symbols(m->lib_path, sym_buf, sizeof(sym_buf))) return;
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define load_ptr(p)     (*(void* volatile*)(p))
+#define store_ptr(p, v) (*(void* volatile*)(p) = (v))
+#define add_long(p, v)  _InterlockedExchangeAdd((p), (v))
+#define cas_long(p, expected, desired) \
+    (_InterlockedCompareExchange((p), (desired), (expected)) == (expected))
+#else
+#define load_ptr(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define store_ptr(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define add_long(p, v)  __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define cas_long(p, expected, desired) \
+    __atomic_compare_exchange_n((p), &(long){expected}, (desired), 0, \
+                                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#endif
 
-    char* line = strtok(sym_buf, "\n");
+#ifdef _WIN32
+#define strtok_r strtok_s
+#endif
+
+#define HR_ELF_SHT_NOTE 7
+
+/* Everything the loader maps, code and data, minus notes (the build id).
+   Two builds with the same image hash behave identically. */
+static hr_hash128_t hash_image(const hr_elf_t* elf) {
+    hr_hasher_t h;
+    hr_hash_init(&h, elf->shnum);
+    for (size_t i = 0; i < elf->shnum; i++) {
+        hr_elf_section_t sec;
+        if (!hr_elf_section(elf, i, &sec)) continue;
+        if (!(sec.flags & HR_ELF_SHF_ALLOC) || sec.type == HR_ELF_SHT_NOTE) continue;
+        hr_hash_u64(&h, sec.type);
+        hr_hash_u64(&h, sec.flags);
+        hr_hash_u64(&h, sec.size);
+        if (sec.data) hr_hash_update(&h, sec.data, (size_t)sec.size);
+    }
+    return hr_hash_final(&h);
+}
+
+static int populate_from_elf(const char* lib_path, void* handle, hr_symbol_table_t* symbols,
+                             hr_hash128_t* image_hash) {
+    size_t size = 0;
+    const void* image = hr_platform_map_file(lib_path, &size);
+    if (!image) return 0;
+    hr_elf_t elf;
+    if (!hr_elf_open(&elf, image, size)) {
+        hr_platform_unmap_file(image, size);
+        return 0;
+    }
+    *image_hash = hash_image(&elf);
+
+    uintptr_t base = 0;
+    int has_base = hr_platform_lib_base(handle, &base);
+    hr_symbols_reserve(symbols, (int)elf.sym_count);
+    for (size_t i = 0; i < elf.sym_count; i++) {
+        hr_elf_symbol_t es;
+        if (!hr_elf_symbol(&elf, i, &es)) continue;
+        if (es.type != HR_ELF_FUNC && es.type != HR_ELF_IFUNC) continue;
+        void* addr = has_base && es.type == HR_ELF_FUNC
+                   ? (void*)(base + (uintptr_t)es.value)
+                   : hr_platform_lib_sym(handle, es.name);
+        if (!addr) continue;
+        hr_symbol_t* sym = hr_symbols_add(symbols, es.name, addr);
+        if (!sym) continue;
+        sym->size = es.size;
+        sym->type = es.type == HR_ELF_FUNC ? HR_SYM_FUNC : HR_SYM_IFUNC;
+        if (sym->type == HR_SYM_FUNC)
+            sym->checksum = hr_symbols_checksum_fn(addr, (size_t)es.size);
+    }
+    hr_platform_unmap_file(image, size);
+    return 1;
+}
+
+static void populate_symbols(hr_adapter_t* adapter, const char* lib_path, void* handle,
+                             hr_symbol_table_t* symbols, hr_hash128_t* image_hash) {
+    memset(image_hash, 0, sizeof(*image_hash));
+    if (populate_from_elf(lib_path, handle, symbols, image_hash)) return;
+
+    char* sym_buf = adapter->list_symbols(lib_path);
+    if (!sym_buf) return;
+
+    int lines = 0;
+    for (const char* p = sym_buf; *p; p++)
+        if (*p == '\n') lines++;
+    hr_symbols_reserve(symbols, lines + 1);
+
+    char* save = NULL;
+    char* line = strtok_r(sym_buf, "\n", &save);
     while (line) {
-        char addr_str[32], type_str[4], sym_name[HR_MAX_NAME];
-        if (sscanf(line, "%31s %3s %255s", addr_str, type_str, sym_name) == 3) {
-            if (type_str[0] == 'T' || type_str[0] == 't' || type_str[0] == 'W') {
-                void* addr = hr_platform_lib_sym(m->lib_handle, sym_name);
-                if (addr) hr_symbols_add(&m->symbols, sym_name, addr);
+        char* fields[3];
+        int   nfields = 0;
+        char* p = line;
+        while (*p && nfields < 3) {
+            while (*p == ' ' || *p == '\t') p++;
+            if (!*p) break;
+            fields[nfields++] = p;
+            while (*p && *p != ' ' && *p != '\t') p++;
+            if (*p) *p++ = 0;
+        }
+        if (nfields == 3) {
+            char type = fields[1][0];
+            if (type == 'T' || type == 't' || type == 'W') {
+                void* addr = hr_platform_lib_sym(handle, fields[2]);
+                if (addr) hr_symbols_add(symbols, fields[2], addr);
             }
         }
-        line = strtok(NULL, "\n");
+        line = strtok_r(NULL, "\n", &save);
     }
+    free(sym_buf);
 }
 
-static void make_lib_path(const char* src, const char* build_dir, char* out, size_t out_sz) {
-    const char* base = strrchr(src, '/');
-    if (!base) base = strrchr(src, '\\');
-    base = base ? base + 1 : src;
-    char name[256];
-    strncpy(name, base, sizeof(name)-1);
-    char* dot = strrchr(name, '.');
+static void path_stem(const char* path, char* out, size_t out_sz) {
+    const char* base = strrchr(path, '/');
+    if (!base) base = strrchr(path, '\\');
+    base = base ? base + 1 : path;
+    snprintf(out, out_sz, "%s", base);
+    char* dot = strrchr(out, '.');
     if (dot) *dot = 0;
-    snprintf(out, out_sz, "%s/hr_%s%s", build_dir, name, hr_platform_lib_ext());
 }
 
-hr_loaded_module_t* hr_loader_open(const char* src_path, const char* build_dir,
-                                   hr_adapter_t* adapter, const char* flags) {
-    hr_platform_mkdir(build_dir);
+static void make_lib_path(const char* src, const char* build_dir, unsigned generation,
+                          char* out, size_t out_sz) {
+    char name[256];
+    path_stem(src, name, sizeof(name));
+    snprintf(out, out_sz, "%s/hr_%s.%d.g%u%s", build_dir, name, hr_platform_process_id(),
+             generation, hr_platform_lib_ext());
+}
 
-    hr_loaded_module_t* m = calloc(1, sizeof(hr_loaded_module_t));
-    if (!m) return NULL;
-    m->adapter = adapter;
-    strncpy(m->src_path, src_path, sizeof(m->src_path)-1);
-    make_lib_path(src_path, build_dir, m->lib_path, sizeof(m->lib_path));
+static void remove_outputs(const hr_loaded_module_t* mod, const char* lib_path) {
+    remove(lib_path);
+    if (mod->adapter->emits_depfile) {
+        char depfile[4096 + 2];
+        snprintf(depfile, sizeof(depfile), "%s.d", lib_path);
+        remove(depfile);
+    }
+}
+
+typedef struct {
+    hr_dep_list_t* deps;
+    const char*    ext;
+} hr_sibling_scan_t;
+
+static void add_sibling(const char* path, int64_t size, int64_t mtime, void* userdata) {
+    (void)size; (void)mtime;
+    hr_sibling_scan_t* scan = userdata;
+    const char* ext = strrchr(path, '.');
+    if (ext && strcmp(ext, scan->ext) == 0) hr_deps_add(scan->deps, path);
+}
+
+/* Compilers without a depfile (rustc, zig, go) may pull in any source next
+   to the root file (mod, @import, package siblings). Recording those as
+   dependencies keys the cache on them and reloads the module when they
+   change. */
+static void collect_siblings(const hr_loaded_module_t* mod, hr_build_t* build) {
+    char dir[4096];
+    if (!mod->adapter->source_ext || !hr_platform_realpath(mod->src_path, dir, sizeof(dir))) return;
+    char* slash = strrchr(dir, '/');
+    if (!slash) slash = strrchr(dir, '\\');
+    if (!slash) return;
+    *slash = 0;
+    hr_sibling_scan_t scan = { &build->deps, mod->adapter->source_ext };
+    hr_platform_list_dir(dir, add_sibling, &scan);
+}
+
+static void collect_deps(const hr_loaded_module_t* mod, hr_build_t* build) {
+    if (!mod->adapter->emits_depfile) {
+        collect_siblings(mod, build);
+        return;
+    }
+    char depfile[4096 + 2];
+    snprintf(depfile, sizeof(depfile), "%s.d", build->lib_path);
+    hr_deps_parse_file(depfile, &build->deps);
+    remove(depfile);
+}
+
+static hr_result_t build_single(const hr_loaded_module_t* mod, const char* flags,
+                                const hr_dep_list_t* prev_deps, volatile int* cancel,
+                                hr_build_t* out, hr_cache_key_t* key) {
+    out->src_mtime = hr_platform_file_mtime(mod->src_path);
+    hr_cache_result_t cached = hr_cache_fetch(mod->stores.cache, mod->adapter, mod->src_path, flags,
+                                              prev_deps, cancel, key, out->lib_path, &out->deps);
+    if (cached == HR_CACHE_FAILED || cached == HR_CACHE_CANCELLED) {
+        if (cached == HR_CACHE_FAILED)
+            fprintf(stderr, "[hr:loader] %s failed to compile in another instance\n", mod->src_path);
+        return HR_ERR_COMPILE;
+    }
+    out->from_cache = cached == HR_CACHE_HIT;
+    if (out->from_cache) return HR_OK;
 
-    if (!adapter->compile(src_path, m->lib_path, flags)) {
-        free(m); return NULL;
+    hr_process_result_t proc;
+    char pch_flags[16384];
+    hr_platform_set_cancel_flag(cancel);
+    int use_pch = hr_pch_prepare(mod->stores.pch, mod->adapter, mod->src_path, flags, cancel,
+                                 pch_flags, sizeof(pch_flags));
+    int ok = mod->adapter->compile(mod->adapter, mod->src_path, out->lib_path,
+                                   use_pch ? pch_flags : flags, &proc);
+    hr_platform_set_cancel_flag(NULL);
+    out->compile_wall_ns = proc.wall_ns;
+    out->compile_cpu_ns  = proc.cpu_ns;
+    hr_platform_process_result_free(&proc);
+    if (!ok || (cancel && *cancel)) {
+        if (!ok) hr_cache_fail(mod->stores.cache, key);
+        remove_outputs(mod, out->lib_path);
+        return HR_ERR_COMPILE;
     }
+    collect_deps(mod, out);
+    return HR_OK;
+}
+
+typedef struct {
+    const char*   src;
+    char          obj[4096 + 300];
+    char          depfile[4096 + 300];
+    char          tmp[4096 + 340];
+    hr_dep_list_t deps;
+    int           compiled;
+    uint64_t      cpu_ns;
+} hr_unit_t;
+
+typedef struct {
+    const hr_loaded_module_t* mod;
+    const char*   flags;
+    volatile int* cancel;
+    hr_unit_t*    units;
+    int           count;
+    int           next;
+    int           failed;
+    int           flags_match;
+    hr_mutex_t*   lock;
+} hr_unit_batch_t;
+
+/* Objects live at <build_dir>/<module>/<stem>.<index>.o next to a depfile
+   written by the loader, so they survive across builds and restarts. A
+   "flags" stamp in the same directory invalidates them all when the
+   compiler flags change. */
+static int read_flags_stamp(const char* path, const char* flags) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    char buf[16384];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = 0;
+    return strcmp(buf, flags ? flags : "") == 0;
+}
+
+static void write_flags_stamp(const char* path, const char* flags) {
+    char tmp[4096 + 32];
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, hr_platform_process_id());
+    FILE* f = fopen(tmp, "wb");
+    if (!f) return;
+    fputs(flags ? flags : "", f);
+    if (fclose(f) != 0 || !hr_platform_rename(tmp, path)) remove(tmp);
+}
 
-    m->lib_handle = hr_platform_lib_open(m->lib_path);
-    if (!m->lib_handle) {
+static int write_depfile(const char* path, const char* target, const hr_dep_list_t* deps) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+    fprintf(f, "%s:", target);
+    for (int i = 0; i < deps->count; i++) {
+        fputs(" \\\n ", f);
+        for (const char* c = deps->paths[i]; *c; c++) {
+            if (*c == ' ' || *c == '#') fputc('\\', f);
+            else if (*c == '$') fputc('$', f);
+            fputc(*c, f);
+        }
+    }
+    fputc('\n', f);
+    return fclose(f) == 0;
+}
+
+/* Make-style check: the object is reused when it is strictly newer than its
+   source and every dependency its depfile lists. Equal timestamps rebuild,
+   since mtimes only have second resolution. */
+static int unit_fresh(hr_unit_t* u) {
+    int64_t obj_mtime = hr_platform_file_mtime(u->obj);
+    if (obj_mtime < 0 || !hr_deps_parse_file(u->depfile, &u->deps)) return 0;
+    int has_src = 0;
+    for (int i = 0; i < u->deps.count; i++) {
+        int64_t mtime = hr_platform_file_mtime(u->deps.paths[i]);
+        if (mtime < 0 || mtime >= obj_mtime) {
+            hr_deps_free(&u->deps);
+            return 0;
+        }
+        if (strcmp(u->deps.paths[i], u->src) == 0) has_src = 1;
+    }
+    if (!has_src) hr_deps_free(&u->deps);
+    return has_src;
+}
+
+static int publish_unit(hr_unit_batch_t* b, hr_unit_t* u) {
+    char dep_tmp[4096 + 344];
+    snprintf(dep_tmp, sizeof(dep_tmp), "%s.d", u->tmp);
+    if (b->cancel && *b->cancel) return 0;
+    if (!write_depfile(dep_tmp, u->obj, &u->deps) || !hr_platform_rename(u->tmp, u->obj)) {
+        remove(dep_tmp);
+        return 0;
+    }
+    if (!hr_platform_rename(dep_tmp, u->depfile)) {
+        remove(dep_tmp);
+        remove(u->depfile);
+    }
+    return 1;
+}
+
+static int build_unit(hr_unit_batch_t* b, hr_unit_t* u) {
+    const hr_loaded_module_t* mod = b->mod;
+    if (b->flags_match && unit_fresh(u)) return 1;
+
+    hr_cache_key_t key;
+    hr_cache_result_t cached = hr_cache_fetch(mod->stores.objects, mod->adapter, u->src, b->flags,
+                                              NULL, b->cancel, &key, u->tmp, &u->deps);
+    if (cached != HR_CACHE_MISS) {
+        if (cached == HR_CACHE_FAILED)
+            fprintf(stderr, "[hr:loader] %s failed to compile in another instance\n", u->src);
+        hr_cache_key_free(&key);
+        if (cached != HR_CACHE_HIT) return 0;
+        hr_deps_add(&u->deps, u->src);
+        if (publish_unit(b, u)) return 1;
+        remove(u->tmp);
+        return 0;
+    }
+
+    hr_process_result_t proc;
+    char pch_flags[16384];
+    int use_pch = hr_pch_prepare(mod->stores.pch, mod->adapter, u->src, b->flags, b->cancel,
+                                 pch_flags, sizeof(pch_flags));
+    int ok = mod->adapter->compile_object(mod->adapter, u->src, u->tmp,
+                                          use_pch ? pch_flags : b->flags, &proc);
+    u->compiled = 1;
+    u->cpu_ns   = proc.cpu_ns;
+    hr_platform_process_result_free(&proc);
+
+    char depfile[4096 + 344];
+    snprintf(depfile, sizeof(depfile), "%s.d", u->tmp);
+    if (ok && !(b->cancel && *b->cancel)) {
+        hr_deps_parse_file(depfile, &u->deps);
+        hr_deps_add(&u->deps, u->src);
+        hr_cache_store(mod->stores.objects, &key, u->src, u->tmp, &u->deps);
+    } else if (!ok) {
+        hr_cache_fail(mod->stores.objects, &key);
+    }
+    remove(depfile);
+    hr_cache_key_free(&key);
+    if (ok && publish_unit(b, u)) return 1;
+    remove(u->tmp);
+    return 0;
+}
+
+/* Compilers are drawn from one budget shared by every build of a context
+   (max_jobs, one per core by default). Each build holds one slot while it
+   compiles; extra unit threads only take the slots that are free. */
+static int take_threads(volatile long* budget, int want) {
+    if (!budget) return want;
+    for (;;) {
+        long avail = *budget;
+        if (avail <= 0) return 0;
+        long n = want < avail ? want : avail;
+        if (cas_long(budget, avail, avail - n)) return (int)n;
+    }
+}
+
+static void give_threads(volatile long* budget, int n) {
+    if (budget && n > 0) add_long(budget, n);
+}
+
+static void unit_worker(void* arg) {
+    hr_unit_batch_t* b = arg;
+    hr_platform_set_cancel_flag(b->cancel);
+    for (;;) {
+        hr_platform_mutex_lock(b->lock);
+        int stop = b->failed || (b->cancel && *b->cancel);
+        int i = stop ? b->count : b->next++;
+        hr_platform_mutex_unlock(b->lock);
+        if (i >= b->count) break;
+        if (!build_unit(b, &b->units[i])) {
+            hr_platform_mutex_lock(b->lock);
+            b->failed = 1;
+            hr_platform_mutex_unlock(b->lock);
+        }
+    }
+    hr_platform_set_cancel_flag(NULL);
+}
+
+static hr_result_t build_units(const hr_loaded_module_t* mod, const char* build_dir,
+                               const char* flags, volatile int* cancel, hr_build_t* out) {
+    int count = mod->source_count;
+    hr_unit_t*   units   = calloc((size_t)count, sizeof(hr_unit_t));
+    const char** objects = calloc((size_t)count, sizeof(char*));
+    hr_unit_batch_t batch = { mod, flags, cancel, units, count, 0, 0, 0, hr_platform_mutex_create() };
+    if (!units || !objects || !batch.lock) {
+        free(units);
+        free(objects);
+        hr_platform_mutex_destroy(batch.lock);
+        return HR_ERR_COMPILE;
+    }
+
+    char dir[4096], stem[256], stamp[4096 + 16];
+    path_stem(mod->src_path, stem, sizeof(stem));
+    snprintf(dir, sizeof(dir), "%s/%s", build_dir, stem);
+    hr_platform_mkdir(dir);
+    snprintf(stamp, sizeof(stamp), "%s/flags", dir);
+    batch.flags_match = read_flags_stamp(stamp, flags);
+
+    for (int i = 0; i < count; i++) {
+        hr_unit_t* u = &units[i];
+        u->src = mod->sources[i];
+        path_stem(u->src, stem, sizeof(stem));
+        snprintf(u->obj, sizeof(u->obj), "%s/%s.%d.o", dir, stem, i);
+        snprintf(u->depfile, sizeof(u->depfile), "%s/%s.%d.d", dir, stem, i);
+        snprintf(u->tmp, sizeof(u->tmp), "%s.%d.g%u.tmp", u->obj, hr_platform_process_id(),
+                 out->generation);
+        hr_deps_init(&u->deps);
+        objects[i] = u->obj;
+        int64_t mtime = hr_platform_file_mtime(u->src);
+        if (mtime > out->src_mtime) out->src_mtime = mtime;
+    }
+
+    uint64_t start = hr_platform_time_ns();
+    int extra = hr_platform_cpu_count() - 1;
+    if (extra > count - 1) extra = count - 1;
+    if (extra > 64) extra = 64;
+    extra = take_threads(mod->stores.thread_budget, extra);
+    hr_thread_t* workers[64];
+    int started = 0;
+    while (started < extra &&
+           (workers[started] = hr_platform_thread_start(unit_worker, &batch)))
+        started++;
+    unit_worker(&batch);
+    for (int i = 0; i < started; i++)
+        hr_platform_thread_join(workers[i]);
+    give_threads(mod->stores.thread_budget, extra);
+
+    int ok = !batch.failed && !(cancel && *cancel);
+    if (ok) {
+        hr_process_result_t proc;
+        hr_platform_set_cancel_flag(cancel);
+        ok = mod->adapter->link(mod->adapter, objects, count, out->lib_path, flags, &proc);
+        hr_platform_set_cancel_flag(NULL);
+        out->compile_cpu_ns += proc.cpu_ns;
+        hr_platform_process_result_free(&proc);
+        if (!ok || (cancel && *cancel)) {
+            remove(out->lib_path);
+            ok = 0;
+        }
+    }
+    out->compile_wall_ns = hr_platform_time_ns() - start;
+    if (ok && !batch.flags_match) write_flags_stamp(stamp, flags);
+
+    for (int i = 0; i < count; i++) {
+        if (units[i].compiled) out->units_compiled++;
+        else                   out->units_reused++;
+        out->compile_cpu_ns += units[i].cpu_ns;
+        for (int d = 0; d < units[i].deps.count; d++)
+            hr_deps_add(&out->deps, units[i].deps.paths[d]);
+        hr_deps_free(&units[i].deps);
+    }
+    hr_platform_mutex_destroy(batch.lock);
+    free(objects);
+    free(units);
+    return ok ? HR_OK : HR_ERR_COMPILE;
+}
+
+hr_result_t hr_loader_build(const hr_loaded_module_t* mod, const char* build_dir,
+                            const char* flags, unsigned generation,
+                            const hr_dep_list_t* prev_deps, volatile int* cancel,
+                            hr_build_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->generation = generation;
+    make_lib_path(mod->src_path, build_dir, generation, out->lib_path, sizeof(out->lib_path));
+    hr_deps_init(&out->deps);
+
+    hr_cache_key_t key;
+    memset(&key, 0, sizeof(key));
+    if (mod->stores.thread_budget) add_long(mod->stores.thread_budget, -1);
+    hr_result_t res = mod->source_count > 0 ? build_units(mod, build_dir, flags, cancel, out)
+                                            : build_single(mod, flags, prev_deps, cancel, out, &key);
+    give_threads(mod->stores.thread_budget, 1);
+    if (res != HR_OK) {
+        hr_deps_free(&out->deps);
+        hr_cache_key_free(&key);
+        return res;
+    }
+
+    out->lib_handle = hr_platform_lib_open(out->lib_path);
+    if (!out->lib_handle) {
         fprintf(stderr, "[hr:loader] dlopen failed: %s\n", hr_platform_lib_error());
-        free(m); return NULL;
+        remove_outputs(mod, out->lib_path);
+        hr_deps_free(&out->deps);
+        hr_cache_key_free(&key);
+        return HR_ERR_LOAD;
+    }
+    if (!out->from_cache)
+        hr_cache_store(mod->stores.cache, &key, mod->src_path, out->lib_path, &out->deps);
+    hr_cache_key_free(&key);
+
+    hr_symbols_init(&out->symbols);
+    populate_symbols(mod->adapter, out->lib_path, out->lib_handle, &out->symbols, &out->image_hash);
+    return HR_OK;
+}
+
+void hr_loader_discard(hr_build_t* build) {
+    if (!build) return;
+    if (build->lib_handle) {
+        hr_platform_lib_close(build->lib_handle);
+        remove(build->lib_path);
+    }
+    hr_symbols_free(&build->symbols);
+    hr_deps_free(&build->deps);
+    build->lib_handle = NULL;
+}
+
+static void free_view(void* item) {
+    hr_symbol_view_t* view = (hr_symbol_view_t*)item;
+    if (!view) return;
+    while (view->extras) {
+        hr_sym_extra_t* next = view->extras->next;
+        free(view->extras->name);
+        free(view->extras);
+        view->extras = next;
+    }
+    if (view->demangled) {
+        hr_symbols_free(view->demangled);
+        free(view->demangled);
     }
+    free(view);
+}
+
+/* Swaps the view lookups read and returns the previous one. A thread may
+   still be searching it, so it stays with its generation and is freed
+   along with it. */
+static hr_symbol_view_t* publish_view(hr_loaded_module_t* mod) {
+    hr_symbol_view_t* view = calloc(1, sizeof(hr_symbol_view_t));
+    if (view) {
+        view->symbols    = mod->symbols;
+        view->lib_handle = mod->lib_handle;
+        view->generation = mod->generation;
+    }
+    hr_symbol_view_t* old = mod->view;
+    store_ptr(&mod->view, view);
+    return old;
+}
+
+static hr_symbol_view_t* adopt_build(hr_loaded_module_t* mod, hr_build_t* build) {
+    hr_symbol_table_t old_symbols = mod->symbols;
+    mod->symbols     = build->symbols;
+    build->symbols   = old_symbols;
+    hr_dep_list_t old_deps = mod->deps;
+    mod->deps        = build->deps;
+    build->deps      = old_deps;
+    mod->lib_handle  = build->lib_handle;
+    mod->generation  = build->generation;
+    mod->compile_wall_ns = build->compile_wall_ns;
+    mod->compile_cpu_ns  = build->compile_cpu_ns;
+    mod->last_mtime  = build->src_mtime;
+    mod->image_hash  = build->image_hash;
+    memcpy(mod->lib_path, build->lib_path, sizeof(mod->lib_path));
+    return publish_view(mod);
+}
 
+static hr_loaded_module_t* open_module(hr_loaded_module_t* m, const char* build_dir,
+                                       const char* flags) {
     hr_symbols_init(&m->symbols);
-    populate_symbols(m);
-    m->last_mtime = hr_platform_file_mtime(src_path);
+    hr_deps_init(&m->deps);
+
+    hr_build_t build;
+    if (hr_loader_build(m, build_dir, flags, 0, &m->deps, NULL, &build) != HR_OK) {
+        hr_loader_close(m);
+        return NULL;
+    }
+    free_view(adopt_build(m, &build));
+    hr_symbols_free(&build.symbols);
+    hr_deps_free(&build.deps);
     return m;
 }
 
+static hr_loaded_module_t* alloc_module(const char* src_path, const char* build_dir,
+                                        hr_adapter_t* adapter, const hr_loader_stores_t* stores) {
+    hr_platform_mkdir(build_dir);
+    hr_loaded_module_t* m = calloc(1, sizeof(hr_loaded_module_t));
+    if (!m) return NULL;
+    m->adapter   = adapter;
+    m->view_lock = hr_platform_mutex_create();
+    if (!m->view_lock) { free(m); return NULL; }
+    if (stores) m->stores = *stores;
+    strncpy(m->src_path, src_path, sizeof(m->src_path)-1);
+    return m;
+}
+
+hr_loaded_module_t* hr_loader_open(const char* src_path, const char* build_dir,
+                                   hr_adapter_t* adapter, const char* flags,
+                                   const hr_loader_stores_t* stores) {
+    hr_loaded_module_t* m = alloc_module(src_path, build_dir, adapter, stores);
+    return m ? open_module(m, build_dir, flags) : NULL;
+}
+
+hr_loaded_module_t* hr_loader_open_units(const char* name, const char* const* sources, int count,
+                                         const char* build_dir, hr_adapter_t* adapter,
+                                         const char* flags, const hr_loader_stores_t* stores) {
+    if (count <= 0 || !adapter->compile_object || !adapter->link) return NULL;
+    hr_loaded_module_t* m = alloc_module(name, build_dir, adapter, stores);
+    if (!m) return NULL;
+    m->sources = calloc((size_t)count, sizeof(char*));
+    if (!m->sources) { hr_platform_mutex_destroy(m->view_lock); free(m); return NULL; }
+    for (int i = 0; i < count; i++) {
+        char real[4096];
+        const char* path = hr_platform_realpath(sources[i], real, sizeof(real)) ? real : sources[i];
+        if (!(m->sources[i] = strdup(path))) {
+            for (int j = 0; j < i; j++) free(m->sources[j]);
+            free(m->sources);
+            hr_platform_mutex_destroy(m->view_lock);
+            free(m);
+            return NULL;
+        }
+    }
+    m->source_count = count;
+    return open_module(m, build_dir, flags);
+}
+
+static void close_generation(hr_generation_t* gen) {
+    hr_platform_lib_close(gen->lib_handle);
+    remove(gen->lib_path);
+    free_view(gen->view);
+    hr_symbols_free(&gen->symbols);
+    free(gen->patches);
+    free(gen->redirects);
+}
+
 void hr_loader_close(hr_loaded_module_t* mod) {
     if (!mod) return;
-    if (mod->lib_handle) hr_platform_lib_close(mod->lib_handle);
-    hr_symbols_clear(&mod->symbols);
+    if (mod->lib_handle) {
+        hr_platform_lib_close(mod->lib_handle);
+        remove(mod->lib_path);
+    }
+    free_view(mod->view);
+    hr_platform_mutex_destroy(mod->view_lock);
+    hr_symbols_free(&mod->symbols);
+    hr_deps_free(&mod->deps);
+    for (int i = 0; i < mod->retained_count; i++)
+        close_generation(&mod->retained[i]);
+    free(mod->retained);
+    hr_arena_destroy(mod->arena);
+    for (int i = 0; i < mod->source_count; i++)
+        free(mod->sources[i]);
+    free(mod->sources);
     free(mod);
 }
 
-hr_result_t hr_loader_reload(hr_loaded_module_t* mod, const char* build_dir, const char* flags,
-                              hr_save_state_fn save_cb, hr_restore_state_fn restore_cb) {
-    hr_state_t state = {NULL, 0};
-    if (save_cb) save_cb(&state);
+/* Makes room for the generation a commit replaces before anything is
+   swapped, so running out of memory leaves the live generation in place
+   rather than releasing code and a view other threads may be using. */
+static hr_generation_t* reserve_generation(hr_loaded_module_t* mod) {
+    hr_generation_t* retained = realloc(mod->retained,
+                                        sizeof(hr_generation_t) * (size_t)(mod->retained_count + 1));
+    if (!retained) return NULL;
+    mod->retained = retained;
+    hr_generation_t* gen = &retained[mod->retained_count];
+    memset(gen, 0, sizeof(*gen));
+    size_t count = (size_t)(mod->symbols.count > 0 ? mod->symbols.count : 1);
+    gen->patches   = calloc(count, sizeof(hr_patch_t));
+    gen->redirects = calloc(count, 1);
+    if (!gen->patches || !gen->redirects) {
+        free(gen->patches);
+        free(gen->redirects);
+        return NULL;
+    }
+    return gen;
+}
 
-    char new_lib[4096];
-    make_lib_path(mod->src_path, build_dir, new_lib, sizeof(new_lib));
+static void retain_generation(hr_loaded_module_t* mod, hr_generation_t* gen, void* handle,
+                              const char* path, unsigned generation, hr_symbol_table_t* symbols,
+                              hr_symbol_view_t* view) {
+    gen->lib_handle = handle;
+    gen->generation = generation;
+    strncpy(gen->lib_path, path, sizeof(gen->lib_path)-1);
+    gen->lib_path[sizeof(gen->lib_path)-1] = 0;
+    gen->symbols = *symbols;
+    gen->view    = view;
+    hr_symbols_init(symbols);
+    mod->retained_count++;
+}
 
-    char tmp_lib[4096];
-    snprintf(tmp_lib, sizeof(tmp_lib), "%s.new%s", new_lib, "");
+typedef struct {
+    hr_got_redirect_t* items;
+    int                count;
+    int                capacity;
+} redirect_map_t;
 
-    if (!mod->adapter->compile(mod->src_path, tmp_lib, flags)) {
-        free(state.data);
-        return HR_ERR_COMPILE;
+static void map_add(redirect_map_t* map, void* from, void* to) {
+    if (map->count >= map->capacity) {
+        int capacity = map->capacity ? map->capacity * 2 : 64;
+        hr_got_redirect_t* items = realloc(map->items, sizeof(hr_got_redirect_t) * (size_t)capacity);
+        if (!items) return;
+        map->items    = items;
+        map->capacity = capacity;
     }
+    map->items[map->count].from = (uintptr_t)from;
+    map->items[map->count].to   = (uintptr_t)to;
+    map->count++;
+}
+
+typedef struct {
+    int near_pending;
+    int slot_retargets;
+} near_counts_t;
 
-    hr_platform_lib_close(mod->lib_handle);
-    mod->lib_handle = NULL;
+/* Points the arena slot for `old` at its newest definition and queues a
+   5-byte jump into that slot over its entry. */
+static int redirect_near(hr_loaded_module_t* mod, hr_symbol_t* old, hr_symbol_t* now,
+                         hr_patch_txn_t* txn, hr_patch_t* patch) {
+    if (!hr_arena_supported() || !hr_patcher_near_size() || old->size < hr_patcher_near_size()) return 0;
+    if (!mod->arena && !(mod->arena = hr_arena_create())) return 0;
+    void* entry = hr_arena_slot(mod->arena, old->name, old->hash, old->current_addr);
+    if (!entry) return 0;
+    hr_arena_set_target(entry, now->current_addr);
+    return hr_patcher_txn_apply_near(txn, old->current_addr, entry, patch);
+}
 
-    rename(tmp_lib, new_lib);
+/* Sends every function of a retained generation that still exists to its
+   newest definition: by a near jump into a shared arena slot, by a full
+   jump written over its entry, or through the GOT slots that import it. A
+   function already jumping into its slot follows the slot's new target
+   without any code being written. */
+static void redirect_generation(hr_loaded_module_t* mod, hr_generation_t* gen, hr_redirect_mode_t mode,
+                                hr_patch_txn_t* txn, redirect_map_t* map, near_counts_t* near) {
+    hr_symbol_table_t* current = &mod->symbols;
+    int code = mode != HR_REDIRECT_GOT && hr_patcher_supported();
+    for (int i = 0; i < gen->symbols.count; i++) {
+        hr_symbol_t* old = &gen->symbols.entries[i];
+        gen->redirects[i] = HR_REDIRECT_OFF;
+        if (old->type != HR_SYM_FUNC) continue;
+        hr_symbol_t* now = hr_symbols_find_hashed(current, old->name, old->hash);
+        if (!now || !now->current_addr || now->current_addr == old->current_addr) continue;
+        hr_patch_t* patch = &gen->patches[i];
+        if (patch->patched && patch->length == (int)hr_patcher_near_size()) {
+            void* entry = hr_arena_slot(mod->arena, old->name, old->hash, old->current_addr);
+            if (!entry) continue;
+            hr_arena_set_target(entry, now->current_addr);
+            near->slot_retargets++;
+            gen->redirects[i] = HR_REDIRECT_TRAMPOLINE;
+        } else if (patch->patched) {
+            hr_patcher_txn_retarget(txn, patch, now->current_addr);
+            gen->redirects[i] = HR_REDIRECT_TRAMPOLINE;
+        } else if (code && redirect_near(mod, old, now, txn, patch)) {
+            near->near_pending++;
+            gen->redirects[i] = HR_REDIRECT_TRAMPOLINE;
+        } else if (code && old->size >= hr_patcher_trampoline_size()) {
+            hr_patcher_txn_apply(txn, old->current_addr, now->current_addr, patch);
+            gen->redirects[i] = HR_REDIRECT_TRAMPOLINE;
+        } else if (mode != HR_REDIRECT_TRAMPOLINE && hr_got_supported()) {
+            map_add(map, old->current_addr, now->current_addr);
+            gen->redirects[i] = HR_REDIRECT_GOT;
+        }
+    }
+}
 
-    mod->lib_handle = hr_platform_lib_open(new_lib);
-    if (!mod->lib_handle) {
-        fprintf(stderr, "[hr:loader] reload dlopen failed: %s\n", hr_platform_lib_error());
-        free(state.data);
+hr_result_t hr_loader_commit(hr_loaded_module_t* mod, hr_build_t* build, hr_redirect_mode_t redirect,
+                             hr_save_state_fn save_cb, hr_restore_state_fn restore_cb) {
+    hr_generation_t* gen = NULL;
+    if (mod->lib_handle && !(gen = reserve_generation(mod))) {
+        fprintf(stderr, "[hr:loader] out of memory, keeping generation %u\n", mod->generation);
+        hr_loader_discard(build);
         return HR_ERR_LOAD;
     }
+    hr_state_t state = {NULL, 0};
+    if (save_cb) save_cb(&state);
 
-    hr_symbols_clear(&mod->symbols);
-    populate_symbols(mod);
-    mod->last_mtime = hr_platform_file_mtime(mod->src_path);
+    void* old_handle = mod->lib_handle;
+    char  old_path[4096];
+    strncpy(old_path, mod->lib_path, sizeof(old_path)-1);
+    old_path[sizeof(old_path)-1] = 0;
+    unsigned old_generation = mod->generation;
+
+    hr_symbol_view_t* old_view = adopt_build(mod, build);
+    build->lib_handle  = NULL;
+    mod->patched_count = 0;
+    mod->near_count    = 0;
+    mod->got_count     = 0;
+    mod->got_slots     = 0;
+    mod->protect_calls = 0;
+    mod->redirect_ns   = 0;
+    if (gen)
+        retain_generation(mod, gen, old_handle, old_path, old_generation, &build->symbols, old_view);
+    else if (mod->stores.reclaimer)
+        hr_reclaim_retire(mod->stores.reclaimer, free_view, old_view);
+    else
+        free_view(old_view);
+    if (redirect != HR_REDIRECT_OFF && gen) {
+        hr_patch_txn_t txn;
+        redirect_map_t map = { NULL, 0, 0 };
+        near_counts_t near = { 0, 0 };
+        hr_patcher_txn_init(&txn);
+        for (int i = 0; i < mod->retained_count; i++)
+            redirect_generation(mod, &mod->retained[i], redirect, &txn, &map, &near);
+        int written = hr_patcher_txn_commit(&txn);
+        mod->patched_count  = written + near.slot_retargets;
+        mod->near_count     = (written > 0 ? near.near_pending : 0) + near.slot_retargets;
+        mod->pause_ns       = txn.pause_ns;
+        mod->threads_paused = txn.threads_paused;
+        mod->protect_calls  = txn.protect_calls;
+        mod->redirect_ns    = txn.elapsed_ns;
+        hr_patcher_txn_free(&txn);
+        uint64_t got_start = hr_platform_time_ns();
+        int got_protects = 0;
+        int slots = hr_got_redirect(map.items, map.count, &got_protects);
+        mod->got_count      = slots >= 0 ? map.count : 0;
+        mod->got_slots      = slots > 0 ? slots : 0;
+        mod->protect_calls += got_protects;
+        if (map.count > 0) mod->redirect_ns += hr_platform_time_ns() - got_start;
+        free(map.items);
+    }
+    hr_symbols_free(&build->symbols);
+    hr_deps_free(&build->deps);
 
     if (restore_cb && state.data) restore_cb(&state);
     free(state.data);
     return HR_OK;
 }
 
+/* Removes the oldest retained generation from the module. Redirections
+   always target the newest generation, but a thread may still be running
+   its code, so it is released later with hr_loader_free_generation. */
+hr_generation_t* hr_loader_detach_oldest(hr_loaded_module_t* mod) {
+    if (mod->retained_count == 0) return NULL;
+    hr_generation_t* gen = malloc(sizeof(hr_generation_t));
+    if (!gen) return NULL;
+    *gen = mod->retained[0];
+    mod->retained_count--;
+    memmove(mod->retained, mod->retained + 1, sizeof(hr_generation_t) * (size_t)mod->retained_count);
+    return gen;
+}
+
+void hr_loader_free_generation(void* gen) {
+    close_generation((hr_generation_t*)gen);
+    free(gen);
+}
+
+static int is_function(const hr_symbol_t* sym) {
+    return sym->type == HR_SYM_FUNC || sym->type == HR_SYM_IFUNC;
+}
+
+/* Counts the exported functions whose machine code differs between the live
+   generation and a finished build, including added and removed ones. */
+int hr_loader_diff(hr_loaded_module_t* mod, hr_build_t* build, int* identical) {
+    hr_symbol_table_t* live = &mod->symbols;
+    hr_symbol_table_t* next = &build->symbols;
+    int changed = 0;
+    for (int i = 0; i < next->count; i++) {
+        const hr_symbol_t* now = &next->entries[i];
+        if (!is_function(now)) continue;
+        const hr_symbol_t* was = hr_symbols_find_hashed(live, now->name, now->hash);
+        if (!was || !is_function(was) || !now->checksum || was->size != now->size ||
+            was->checksum != now->checksum)
+            changed++;
+    }
+    for (int i = 0; i < live->count; i++) {
+        const hr_symbol_t* was = &live->entries[i];
+        if (!is_function(was)) continue;
+        const hr_symbol_t* now = hr_symbols_find_hashed(next, was->name, was->hash);
+        if (!now || !is_function(now)) changed++;
+    }
+    const hr_hash128_t none = {0, 0};
+    *identical = !hr_hash_equal(mod->image_hash, none) &&
+                 hr_hash_equal(mod->image_hash, build->image_hash);
+    return changed;
+}
+
+void hr_loader_keep(hr_loaded_module_t* mod, hr_build_t* build) {
+    hr_dep_list_t old_deps = mod->deps;
+    mod->deps       = build->deps;
+    build->deps     = old_deps;
+    mod->last_mtime = build->src_mtime;
+    mod->compile_wall_ns = build->compile_wall_ns;
+    mod->compile_cpu_ns  = build->compile_cpu_ns;
+    hr_loader_discard(build);
+}
+
+static void index_demangled(hr_symbol_table_t* index, const char* key, void* addr) {
+    hr_symbol_t* sym = hr_symbols_find(index, key);
+    if (!sym) hr_symbols_add(index, key, addr);
+    else if (sym->current_addr != addr) sym->current_addr = NULL;
+}
+
+static hr_symbol_table_t* build_demangled_index(hr_adapter_t* adapter, hr_symbol_table_t* symbols) {
+    hr_symbol_table_t* index = malloc(sizeof(hr_symbol_table_t));
+    if (!index) return NULL;
+    hr_symbols_init(index);
+    if (!adapter->demangle) return index;
+    hr_symbols_reserve(index, symbols->count * 2);
+    char key[4096], base[4096];
+    for (int i = 0; i < symbols->count; i++) {
+        const hr_symbol_t* sym = &symbols->entries[i];
+        char* demangled = adapter->demangle(sym->name);
+        if (!demangled) continue;
+        if (strcmp(demangled, sym->name) != 0) {
+            hr_demangle_normalize(demangled, key, sizeof(key));
+            index_demangled(index, key, sym->current_addr);
+            if (hr_demangle_base_name(key, base, sizeof(base)))
+                index_demangled(index, base, sym->current_addr);
+        }
+        free(demangled);
+    }
+    return index;
+}
+
+/* Built on first use; readers that find it missing build it under the
+   view lock, readers that find it published never lock. */
+static hr_symbol_table_t* demangled_index(hr_loaded_module_t* mod, hr_symbol_view_t* view) {
+    hr_symbol_table_t* index = load_ptr(&view->demangled);
+    if (index) return index;
+    hr_platform_mutex_lock(mod->view_lock);
+    index = view->demangled;
+    if (!index) {
+        index = build_demangled_index(mod->adapter, &view->symbols);
+        store_ptr(&view->demangled, index);
+    }
+    hr_platform_mutex_unlock(mod->view_lock);
+    return index;
+}
+
+static hr_symbol_view_t* current_view(hr_loaded_module_t* mod) {
+    return (hr_symbol_view_t*)load_ptr(&mod->view);
+}
+
+static void* find_demangled(hr_loaded_module_t* mod, hr_symbol_view_t* view, const char* name) {
+    hr_symbol_table_t* index = demangled_index(mod, view);
+    if (!index) return NULL;
+    char key[4096];
+    hr_demangle_normalize(name, key, sizeof(key));
+    hr_symbol_t* sym = hr_symbols_find(index, key);
+    return sym ? sym->current_addr : NULL;
+}
+
+void* hr_loader_get_sym_demangled(hr_loaded_module_t* mod, const char* name) {
+    hr_symbol_view_t* view = mod ? current_view(mod) : NULL;
+    if (!view || !view->lib_handle) return NULL;
+    return find_demangled(mod, view, name);
+}
+
+static hr_sym_extra_t* find_extra(hr_symbol_view_t* view, const char* name, uint64_t hash) {
+    for (hr_sym_extra_t* e = load_ptr(&view->extras); e; e = e->next) {
+        if (e->hash == hash && strcmp(e->name, name) == 0) return e;
+    }
+    return NULL;
+}
+
+/* Names the symbol table does not hold are prepended to the view once
+   resolved, by dlsym or by demangled name, or found missing (addr NULL),
+   so later lookups skip dlsym and its loader lock. A reader walking the
+   list sees the entry before or after, never torn. */
+static void add_extra(hr_loaded_module_t* mod, hr_symbol_view_t* view, const char* name,
+                      uint64_t hash, void* addr) {
+    hr_sym_extra_t* e = malloc(sizeof(hr_sym_extra_t));
+    if (!e) return;
+    e->name = strdup(name);
+    e->hash = hash;
+    e->addr = addr;
+    if (!e->name) { free(e); return; }
+    hr_platform_mutex_lock(mod->view_lock);
+    if (find_extra(view, name, hash)) {
+        free(e->name);
+        free(e);
+    } else {
+        e->next = view->extras;
+        store_ptr(&view->extras, e);
+    }
+    hr_platform_mutex_unlock(mod->view_lock);
+}
+
+/* Wait-free when the name is in the generation's table; never blocks on a
+   reload, which only swaps the view pointer. */
 void* hr_loader_get_sym(hr_loaded_module_t* mod, const char* name) {
-    if (!mod) return NULL;
-    hr_symbol_t* sym = hr_symbols_find(&mod->symbols, name);
+    hr_symbol_view_t* view = mod ? current_view(mod) : NULL;
+    if (!view || !view->lib_handle) return NULL;
+    uint64_t hash = hr_symbols_hash(name);
+    hr_symbol_t* sym = hr_symbols_find_hashed(&view->symbols, name, hash);
     if (sym) return sym->current_addr;
-    void* addr = hr_platform_lib_sym(mod->lib_handle, name);
-    if (addr) hr_symbols_add(&mod->symbols, name, addr);
+    hr_sym_extra_t* extra = find_extra(view, name, hash);
+    if (extra) return extra->addr;
+    void* addr = hr_platform_lib_sym(view->lib_handle, name);
+    if (!addr) addr = find_demangled(mod, view, name);
+    add_extra(mod, view, name, hash, addr);
     return addr;
 }
@@ -3,22 +3,125 @@
 
 #include "../../include/hotreload.h"
 #include "hr_symbols.h"
+#include "hr_deps.h"
+#include "hr_cache.h"
+#include "hr_pch.h"
+#include "hr_patcher.h"
+#include "hr_arena.h"
+#include "hr_reclaim.h"
 #include "../adapters/hr_adapter.h"
+#include "../platform/hr_platform.h"
+
+typedef enum {
+    HR_REDIRECT_OFF = 0,
+    HR_REDIRECT_AUTO,
+    HR_REDIRECT_TRAMPOLINE,
+    HR_REDIRECT_GOT
+} hr_redirect_mode_t;
+
+typedef struct {
+    hr_cache_t*     cache;
+    hr_cache_t*     objects;
+    hr_pch_t*       pch;
+    hr_reclaimer_t* reclaimer;
+    volatile long*  thread_budget;
+} hr_loader_stores_t;
+
+typedef struct hr_sym_extra {
+    char*                name;
+    uint64_t             hash;
+    void*                addr;
+    struct hr_sym_extra* next;
+} hr_sym_extra_t;
+
+/* What lookups read: the symbols of one generation, published once and
+   never modified afterwards, apart from the write-once demangled index and
+   the append-only list of names only dlsym knew. A replaced view is kept
+   with its generation, which owns the table arrays, and freed with it. */
+typedef struct {
+    hr_symbol_table_t  symbols;
+    void*              lib_handle;
+    unsigned           generation;
+    hr_symbol_table_t* demangled;
+    hr_sym_extra_t*    extras;
+} hr_symbol_view_t;
 
 typedef struct {
-    void*            lib_handle;
-    char             lib_path[4096];
-    char             src_path[4096];
-    hr_adapter_t*    adapter;
+    void*             lib_handle;
+    char              lib_path[4096];
     hr_symbol_table_t symbols;
-    int64_t          last_mtime;
+    hr_dep_list_t     deps;
+    int64_t           src_mtime;
+    hr_hash128_t      image_hash;
+    unsigned          generation;
+    int               from_cache;
+    int               units_compiled;
+    int               units_reused;
+    uint64_t          compile_wall_ns;
+    uint64_t          compile_cpu_ns;
+} hr_build_t;
+
+typedef struct {
+    void*             lib_handle;
+    char              lib_path[4096];
+    unsigned          generation;
+    hr_symbol_table_t symbols;
+    hr_symbol_view_t* view;
+    hr_patch_t*       patches;
+    unsigned char*    redirects;
+} hr_generation_t;
+
+typedef struct {
+    void*              lib_handle;
+    char               lib_path[4096];
+    char               src_path[4096];
+    char**             sources;
+    int                source_count;
+    hr_adapter_t*      adapter;
+    hr_loader_stores_t stores;
+    hr_symbol_table_t  symbols;
+    hr_symbol_view_t*  view;
+    hr_mutex_t*        view_lock;
+    hr_dep_list_t      deps;
+    int64_t            last_mtime;
+    hr_hash128_t       image_hash;
+    unsigned           generation;
+    unsigned           next_generation;
+    uint64_t           compile_wall_ns;
+    uint64_t           compile_cpu_ns;
+    hr_generation_t*   retained;
+    int                retained_count;
+    hr_arena_t*        arena;
+    int                patched_count;
+    int                near_count;
+    int                got_count;
+    int                got_slots;
+    int                threads_paused;
+    int                protect_calls;
+    uint64_t           pause_ns;
+    uint64_t           redirect_ns;
 } hr_loaded_module_t;
 
 hr_loaded_module_t* hr_loader_open(const char* src_path, const char* build_dir,
-                                   hr_adapter_t* adapter, const char* flags);
+                                   hr_adapter_t* adapter, const char* flags,
+                                   const hr_loader_stores_t* stores);
+hr_loaded_module_t* hr_loader_open_units(const char* name, const char* const* sources, int count,
+                                         const char* build_dir, hr_adapter_t* adapter,
+                                         const char* flags, const hr_loader_stores_t* stores);
 void                hr_loader_close(hr_loaded_module_t* mod);
-hr_result_t         hr_loader_reload(hr_loaded_module_t* mod, const char* build_dir, const char* flags,
+hr_generation_t*    hr_loader_detach_oldest(hr_loaded_module_t* mod);
+void                hr_loader_free_generation(void* gen);
+hr_result_t         hr_loader_build(const hr_loaded_module_t* mod, const char* build_dir,
+                                    const char* flags, unsigned generation,
+                                    const hr_dep_list_t* prev_deps, volatile int* cancel,
+                                    hr_build_t* out);
+hr_result_t         hr_loader_commit(hr_loaded_module_t* mod, hr_build_t* build,
+                                     hr_redirect_mode_t redirect,
                                      hr_save_state_fn save_cb, hr_restore_state_fn restore_cb);
+void                hr_loader_discard(hr_build_t* build);
+int                 hr_loader_diff(hr_loaded_module_t* mod, hr_build_t* build, int* identical);
+void                hr_loader_keep(hr_loaded_module_t* mod, hr_build_t* build);
 void*               hr_loader_get_sym(hr_loaded_module_t* mod, const char* name);
+void*               hr_loader_get_sym_demangled(hr_loaded_module_t* mod, const char* name);
 
 #endif
@@ -1,6 +1,7 @@
 #include "hr_patcher.h"
 #include "../platform/hr_platform.h"
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
 
@@ -23,6 +24,33 @@ int hr_patcher_supported(void) {
 #endif
 }
 
+size_t hr_patcher_trampoline_size(void) {
+    return TRAMPOLINE_SIZE;
+}
+
+/* A `jmp rel32`, only on x86_64; other targets use the full trampoline. */
+size_t hr_patcher_near_size(void) {
+#ifdef HR_ARCH_X64
+    return 5;
+#else
+    return 0;
+#endif
+}
+
+static void flush_icache(void* addr, size_t size) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin___clear_cache((char*)addr, (char*)addr + size);
+#else
+    (void)addr; (void)size;
+#endif
+}
+
+#ifdef HR_ARCH_UNSUPPORTED
+static void write_trampoline(unsigned char* buf, void* target) {
+    (void)buf; (void)target;
+}
+#endif
+
 #ifdef HR_ARCH_X64
 static void write_trampoline(unsigned char* buf, void* target) {
     uint64_t addr = (uint64_t)(uintptr_t)target;
@@ -54,42 +82,215 @@ static void write_trampoline(unsigned char* buf, void* target) {
 }
 #endif
 
-int hr_patcher_apply(void* target_fn, void* new_fn, hr_patch_t* out_patch) {
-#ifdef HR_ARCH_UNSUPPORTED
-    (void)target_fn; (void)new_fn; (void)out_patch;
-    fprintf(stderr, "[hr:patcher] unsupported architecture\n");
-    return 0;
-#else
-    if (!target_fn || !new_fn || !out_patch) return 0;
+#define HR_PATCH_ATTEMPTS 50
 
+void hr_patcher_txn_init(hr_patch_txn_t* txn) {
+    memset(txn, 0, sizeof(*txn));
+}
+
+void hr_patcher_txn_free(hr_patch_txn_t* txn) {
+    free(txn->ops);
+    memset(txn, 0, sizeof(*txn));
+}
+
+static hr_patch_op_t* txn_push(hr_patch_txn_t* txn, hr_patch_t* patch, void* target, int length) {
+    if (txn->count >= txn->capacity) {
+        int capacity = txn->capacity ? txn->capacity * 2 : 16;
+        hr_patch_op_t* ops = realloc(txn->ops, sizeof(hr_patch_op_t) * (size_t)capacity);
+        if (!ops) return NULL;
+        txn->ops      = ops;
+        txn->capacity = capacity;
+    }
+    hr_patch_op_t* op = &txn->ops[txn->count++];
+    op->patch  = patch;
+    op->target = target;
+    op->length = length;
+    return op;
+}
+
+int hr_patcher_txn_apply(hr_patch_txn_t* txn, void* target_fn, void* new_fn, hr_patch_t* out_patch) {
+    if (!hr_patcher_supported() || !target_fn || !new_fn || !out_patch) return 0;
+    hr_patch_op_t* op = txn_push(txn, out_patch, target_fn, TRAMPOLINE_SIZE);
+    if (!op) return 0;
     out_patch->target_addr = target_fn;
     out_patch->patched     = 0;
+    out_patch->length      = TRAMPOLINE_SIZE;
     memcpy(out_patch->original_bytes, target_fn, TRAMPOLINE_SIZE);
+    write_trampoline(op->code, new_fn);
+    return 1;
+}
 
-    if (!hr_platform_make_writable(target_fn, TRAMPOLINE_SIZE)) {
-        fprintf(stderr, "[hr:patcher] cannot make memory writable\n");
-        return 0;
+int hr_patcher_txn_apply_near(hr_patch_txn_t* txn, void* target_fn, void* dest, hr_patch_t* out_patch) {
+    if (!hr_patcher_near_size() || !target_fn || !dest || !out_patch) return 0;
+    int64_t rel = (int64_t)((uintptr_t)dest - ((uintptr_t)target_fn + 5));
+    if (rel < INT32_MIN || rel > INT32_MAX) return 0;
+    hr_patch_op_t* op = txn_push(txn, out_patch, target_fn, 5);
+    if (!op) return 0;
+    out_patch->target_addr = target_fn;
+    out_patch->patched     = 0;
+    out_patch->length      = 5;
+    memcpy(out_patch->original_bytes, target_fn, 5);
+    uint32_t disp = (uint32_t)(int32_t)rel;
+    op->code[0] = 0xE9;
+    memcpy(op->code + 1, &disp, sizeof(disp));
+    return 1;
+}
+
+/* Always rewrites the full-size trampoline; a near jump is retargeted
+   through its arena slot instead. */
+int hr_patcher_txn_retarget(hr_patch_txn_t* txn, hr_patch_t* patch, void* new_fn) {
+    if (!hr_patcher_supported() || !patch || !patch->patched || !new_fn) return 0;
+    if (patch->length != TRAMPOLINE_SIZE) return 0;
+    hr_patch_op_t* op = txn_push(txn, patch, patch->target_addr, TRAMPOLINE_SIZE);
+    if (!op) return 0;
+    write_trampoline(op->code, new_fn);
+    return 1;
+}
+
+/* A thread stopped on the first byte has not executed any of the range yet
+   and will run the new jump; anywhere else inside it is unsafe. */
+static int ip_in_ops(uintptr_t ip, void* userdata) {
+    const hr_patch_txn_t* txn = (const hr_patch_txn_t*)userdata;
+    for (int i = 0; i < txn->count; i++) {
+        uintptr_t start = (uintptr_t)txn->ops[i].target;
+        if (ip > start && ip < start + (uintptr_t)txn->ops[i].length) return 1;
     }
+    return 0;
+}
 
-    unsigned char trampoline[TRAMPOLINE_SIZE];
-    write_trampoline(trampoline, new_fn);
-    memcpy(target_fn, trampoline, TRAMPOLINE_SIZE);
+/* Pauses the other threads, then steps the ones stopped inside a range about
+   to be rewritten until none is. Returns the number of threads paused, or -1
+   with every thread running again. */
+static int pause_outside(hr_patch_txn_t* txn) {
+    int paused = hr_platform_thread_pause_others();
+    if (paused < 0) return -1;
+    int busy = 0;
+    for (int t = 0; t < paused; t++)
+        busy += ip_in_ops(hr_platform_thread_paused_ip(t), txn);
+    for (txn->attempts = 1; busy > 0 && txn->attempts < HR_PATCH_ATTEMPTS; txn->attempts++)
+        busy = hr_platform_thread_step(ip_in_ops, txn);
+    if (busy != 0) {
+        hr_platform_thread_resume_others();
+        return -1;
+    }
+    return paused;
+}
 
-    if (!hr_platform_make_executable(target_fn, TRAMPOLINE_SIZE)) {
-        memcpy(target_fn, out_patch->original_bytes, TRAMPOLINE_SIZE);
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+} page_range_t;
+
+static int compare_addr(const void* a, const void* b) {
+    uintptr_t x = *(const uintptr_t*)a, y = *(const uintptr_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Collapses the pages touched by the ops into maximal runs of adjacent
+   pages, so each run is reprotected with a single call. */
+static int page_ranges(const hr_patch_txn_t* txn, page_range_t** out) {
+    uintptr_t page = (uintptr_t)hr_platform_page_size();
+    uintptr_t* pages = malloc(sizeof(uintptr_t) * (size_t)txn->count * 2);
+    page_range_t* ranges = malloc(sizeof(page_range_t) * (size_t)txn->count * 2);
+    if (!pages || !ranges) { free(pages); free(ranges); return -1; }
+
+    int n = 0;
+    for (int i = 0; i < txn->count; i++) {
+        uintptr_t first = (uintptr_t)txn->ops[i].target;
+        pages[n++] = first & ~(page - 1);
+        pages[n++] = (first + (uintptr_t)txn->ops[i].length - 1) & ~(page - 1);
+    }
+    qsort(pages, (size_t)n, sizeof(uintptr_t), compare_addr);
+
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (count > 0 && pages[i] <= ranges[count-1].end) {
+            if (pages[i] == ranges[count-1].end) ranges[count-1].end += page;
+            continue;
+        }
+        ranges[count].start = pages[i];
+        ranges[count].end   = pages[i] + page;
+        count++;
+    }
+    free(pages);
+    *out = ranges;
+    return count;
+}
+
+static void protect_exec(hr_patch_txn_t* txn, const page_range_t* ranges, int count) {
+    for (int i = 0; i < count; i++) {
+        hr_platform_make_executable((void*)ranges[i].start, ranges[i].end - ranges[i].start);
+        txn->protect_calls++;
+    }
+}
+
+/* Returns the number of patches written; all of them or none. */
+int hr_patcher_txn_commit(hr_patch_txn_t* txn) {
+    if (txn->count == 0) return 0;
+    uint64_t begin = hr_platform_time_ns();
+    page_range_t* ranges = NULL;
+    int range_count = page_ranges(txn, &ranges);
+    if (range_count < 0) return 0;
+    for (int i = 0; i < range_count; i++) {
+        txn->protect_calls++;
+        if (!hr_platform_make_writable((void*)ranges[i].start, ranges[i].end - ranges[i].start)) {
+            fprintf(stderr, "[hr:patcher] cannot make memory writable\n");
+            protect_exec(txn, ranges, i);
+            free(ranges);
+            txn->elapsed_ns = hr_platform_time_ns() - begin;
+            return 0;
+        }
+    }
+
+    uint64_t start = hr_platform_time_ns();
+    int paused = pause_outside(txn);
+    if (paused >= 0) {
+        for (int i = 0; i < txn->count; i++)
+            memcpy(txn->ops[i].target, txn->ops[i].code, (size_t)txn->ops[i].length);
+        txn->pause_ns = hr_platform_time_ns() - start;
+        hr_platform_thread_resume_others();
+    }
+    txn->threads_paused = paused > 0 ? paused : 0;
+
+    protect_exec(txn, ranges, range_count);
+    free(ranges);
+    for (int i = 0; i < txn->count; i++) {
+        hr_patch_op_t* op = &txn->ops[i];
+        flush_icache(op->target, (size_t)op->length);
+        if (paused >= 0) op->patch->patched = 1;
+    }
+    txn->elapsed_ns = hr_platform_time_ns() - begin;
+    if (paused < 0) {
+        fprintf(stderr, "[hr:patcher] could not pause threads outside the patched code\n");
         return 0;
     }
+    return txn->count;
+}
 
-    out_patch->patched = 1;
-    return 1;
-#endif
+int hr_patcher_apply(void* target_fn, void* new_fn, hr_patch_t* out_patch) {
+    hr_patch_txn_t txn;
+    hr_patcher_txn_init(&txn);
+    int ok = hr_patcher_txn_apply(&txn, target_fn, new_fn, out_patch) && hr_patcher_txn_commit(&txn) == 1;
+    hr_patcher_txn_free(&txn);
+    return ok;
+}
+
+int hr_patcher_retarget(hr_patch_t* patch, void* new_fn) {
+    hr_patch_txn_t txn;
+    hr_patcher_txn_init(&txn);
+    int ok = hr_patcher_txn_retarget(&txn, patch, new_fn) && hr_patcher_txn_commit(&txn) == 1;
+    hr_patcher_txn_free(&txn);
+    return ok;
 }
 
 int hr_patcher_revert(hr_patch_t* patch) {
     if (!patch || !patch->patched) return 0;
-    if (!hr_platform_make_writable(patch->target_addr, TRAMPOLINE_SIZE)) return 0;
-    memcpy(patch->target_addr, patch->original_bytes, TRAMPOLINE_SIZE);
-    hr_platform_make_executable(patch->target_addr, TRAMPOLINE_SIZE);
-    patch->patched = 0;
-    return 1;
+    hr_patch_txn_t txn;
+    hr_patcher_txn_init(&txn);
+    hr_patch_op_t* op = txn_push(&txn, patch, patch->target_addr, patch->length);
+    if (op) memcpy(op->code, patch->original_bytes, (size_t)patch->length);
+    int ok = op && hr_patcher_txn_commit(&txn) == 1;
+    hr_patcher_txn_free(&txn);
+    if (ok) patch->patched = 0;
+    return ok;
 }
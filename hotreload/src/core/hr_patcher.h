@@ -2,15 +2,48 @@
 #define HR_PATCHER_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct {
     void*  target_addr;
     unsigned char original_bytes[16];
     int    patched;
+    int    length;
 } hr_patch_t;
 
-int  hr_patcher_apply(void* target_fn, void* new_fn, hr_patch_t* out_patch);
-int  hr_patcher_revert(hr_patch_t* patch);
-int  hr_patcher_supported(void);
+typedef struct {
+    hr_patch_t*   patch;
+    void*         target;
+    int           length;
+    unsigned char code[16];
+} hr_patch_op_t;
+
+/* A set of patches written together while every other thread is paused
+   outside the patched bytes. Protections are changed once per run of
+   adjacent pages, not once per patch. */
+typedef struct {
+    hr_patch_op_t* ops;
+    int            count;
+    int            capacity;
+    int            threads_paused;
+    int            attempts;
+    int            protect_calls;
+    uint64_t       pause_ns;
+    uint64_t       elapsed_ns;
+} hr_patch_txn_t;
+
+void   hr_patcher_txn_init(hr_patch_txn_t* txn);
+int    hr_patcher_txn_apply(hr_patch_txn_t* txn, void* target_fn, void* new_fn, hr_patch_t* out_patch);
+int    hr_patcher_txn_apply_near(hr_patch_txn_t* txn, void* target_fn, void* dest, hr_patch_t* out_patch);
+int    hr_patcher_txn_retarget(hr_patch_txn_t* txn, hr_patch_t* patch, void* new_fn);
+int    hr_patcher_txn_commit(hr_patch_txn_t* txn);
+void   hr_patcher_txn_free(hr_patch_txn_t* txn);
+
+int    hr_patcher_apply(void* target_fn, void* new_fn, hr_patch_t* out_patch);
+int    hr_patcher_retarget(hr_patch_t* patch, void* new_fn);
+int    hr_patcher_revert(hr_patch_t* patch);
+int    hr_patcher_supported(void);
+size_t hr_patcher_trampoline_size(void);
+size_t hr_patcher_near_size(void);
 
 #endif
@@ -0,0 +1,117 @@
+#include "hr_pathmap.h"
+#include "hr_symbols.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HR_PATHMAP_MIN 16
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static int ctz64(uint64_t v) { unsigned long i; _BitScanForward64(&i, v); return (int)i; }
+#else
+static int ctz64(uint64_t v) { return __builtin_ctzll(v); }
+#endif
+
+typedef struct {
+    char*       path;
+    uint64_t    hash;
+    hr_modset_t modules;
+} hr_path_entry_t;
+
+struct hr_pathmap {
+    hr_path_entry_t* slots;
+    int              capacity;
+    int              count;
+};
+
+int hr_modset_any(const hr_modset_t* s) {
+    for (int i = 0; i < HR_MODSET_WORDS; i++)
+        if (s->bits[i]) return 1;
+    return 0;
+}
+
+void hr_modset_or(hr_modset_t* dst, const hr_modset_t* src) {
+    for (int i = 0; i < HR_MODSET_WORDS; i++)
+        dst->bits[i] |= src->bits[i];
+}
+
+int hr_modset_next(const hr_modset_t* s, int from) {
+    for (int id = from; id < HR_MAX_MODULES; id++) {
+        uint64_t word = s->bits[id >> 6] >> (id & 63);
+        if (!word) { id |= 63; continue; }
+        return id + ctz64(word);
+    }
+    return -1;
+}
+
+static hr_path_entry_t* probe(const hr_pathmap_t* map, const char* path, uint64_t hash) {
+    uint32_t mask = (uint32_t)map->capacity - 1;
+    for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1) & mask) {
+        hr_path_entry_t* e = &map->slots[i];
+        if (!e->path || (e->hash == hash && strcmp(e->path, path) == 0))
+            return e;
+    }
+}
+
+static int grow(hr_pathmap_t* map) {
+    int capacity = map->capacity ? map->capacity * 2 : HR_PATHMAP_MIN;
+    hr_path_entry_t* old = map->slots;
+    int old_capacity     = map->capacity;
+    map->slots = calloc((size_t)capacity, sizeof(hr_path_entry_t));
+    if (!map->slots) { map->slots = old; return 0; }
+    map->capacity = capacity;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].path) *probe(map, old[i].path, old[i].hash) = old[i];
+    }
+    free(old);
+    return 1;
+}
+
+hr_pathmap_t* hr_pathmap_create(void) {
+    hr_pathmap_t* map = calloc(1, sizeof(hr_pathmap_t));
+    if (map && !grow(map)) { free(map); return NULL; }
+    return map;
+}
+
+void hr_pathmap_destroy(hr_pathmap_t* map) {
+    if (!map) return;
+    for (int i = 0; i < map->capacity; i++)
+        free(map->slots[i].path);
+    free(map->slots);
+    free(map);
+}
+
+int hr_pathmap_add(hr_pathmap_t* map, const char* path, int id) {
+    if ((map->count + 1) * 2 > map->capacity && !grow(map)) return 0;
+    uint64_t hash = hr_symbols_hash(path);
+    hr_path_entry_t* e = probe(map, path, hash);
+    if (!e->path) {
+        e->path = strdup(path);
+        if (!e->path) return 0;
+        e->hash = hash;
+        memset(&e->modules, 0, sizeof(e->modules));
+        map->count++;
+    }
+    hr_modset_set(&e->modules, id);
+    return 1;
+}
+
+void hr_pathmap_remove(hr_pathmap_t* map, const char* path, int id) {
+    hr_path_entry_t* e = probe(map, path, hr_symbols_hash(path));
+    if (e->path) hr_modset_clear(&e->modules, id);
+}
+
+void hr_pathmap_remove_id(hr_pathmap_t* map, int id) {
+    for (int i = 0; i < map->capacity; i++) {
+        if (map->slots[i].path) hr_modset_clear(&map->slots[i].modules, id);
+    }
+}
+
+const hr_modset_t* hr_pathmap_find(const hr_pathmap_t* map, const char* path) {
+    hr_path_entry_t* e = probe(map, path, hr_symbols_hash(path));
+    return e->path ? &e->modules : NULL;
+}
+
+int hr_pathmap_count(const hr_pathmap_t* map) {
+    return map->count;
+}
@@ -0,0 +1,31 @@
+#ifndef HR_PATHMAP_H
+#define HR_PATHMAP_H
+
+#include <stdint.h>
+
+#define HR_MAX_MODULES   64
+#define HR_MODSET_WORDS  ((HR_MAX_MODULES + 63) / 64)
+
+typedef struct {
+    uint64_t bits[HR_MODSET_WORDS];
+} hr_modset_t;
+
+typedef struct hr_pathmap hr_pathmap_t;
+
+static inline void hr_modset_set(hr_modset_t* s, int id)   { s->bits[id >> 6] |=  (1ULL << (id & 63)); }
+static inline void hr_modset_clear(hr_modset_t* s, int id) { s->bits[id >> 6] &= ~(1ULL << (id & 63)); }
+static inline int  hr_modset_test(const hr_modset_t* s, int id) { return (s->bits[id >> 6] >> (id & 63)) & 1; }
+
+int  hr_modset_any(const hr_modset_t* s);
+void hr_modset_or(hr_modset_t* dst, const hr_modset_t* src);
+int  hr_modset_next(const hr_modset_t* s, int from);
+
+hr_pathmap_t*      hr_pathmap_create(void);
+void               hr_pathmap_destroy(hr_pathmap_t* map);
+int                hr_pathmap_add(hr_pathmap_t* map, const char* path, int id);
+void               hr_pathmap_remove(hr_pathmap_t* map, const char* path, int id);
+void               hr_pathmap_remove_id(hr_pathmap_t* map, int id);
+const hr_modset_t* hr_pathmap_find(const hr_pathmap_t* map, const char* path);
+int                hr_pathmap_count(const hr_pathmap_t* map);
+
+#endif
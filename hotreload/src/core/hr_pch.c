@@ -0,0 +1,298 @@
+#include "hr_pch.h"
+#include "hr_deps.h"
+#include "hr_hash.h"
+#include "../platform/hr_platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define strtok_r strtok_s
+#endif
+
+#define HR_PCH_VERSION       1
+#define HR_PCH_MAX_PREFIX    16384
+#define HR_PCH_MAX_COMPILERS 8
+#define HR_PCH_WAIT_MS       10
+
+typedef struct {
+    const hr_adapter_t* adapter;
+    hr_hash128_t        id;
+} hr_pch_compiler_t;
+
+struct hr_pch {
+    char              dir[4096];
+    hr_mutex_t*       lock;
+    hr_pch_stats_t    stats;
+    hr_pch_compiler_t compilers[HR_PCH_MAX_COMPILERS];
+    int               compiler_count;
+    unsigned          tmp_counter;
+};
+
+hr_pch_t* hr_pch_open(const char* build_dir) {
+    hr_pch_t* pch = calloc(1, sizeof(hr_pch_t));
+    if (!pch) return NULL;
+    snprintf(pch->dir, sizeof(pch->dir), "%s/pch", build_dir);
+    if (!hr_platform_mkdir(pch->dir) || !(pch->lock = hr_platform_mutex_create())) {
+        free(pch);
+        return NULL;
+    }
+    return pch;
+}
+
+void hr_pch_close(hr_pch_t* pch) {
+    if (!pch) return;
+    hr_platform_mutex_destroy(pch->lock);
+    free(pch);
+}
+
+void hr_pch_get_stats(hr_pch_t* pch, hr_pch_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!pch) return;
+    hr_platform_mutex_lock(pch->lock);
+    *out = pch->stats;
+    hr_platform_mutex_unlock(pch->lock);
+}
+
+static hr_hash128_t compiler_identity(hr_pch_t* pch, const hr_adapter_t* adapter) {
+    hr_platform_mutex_lock(pch->lock);
+    for (int i = 0; i < pch->compiler_count; i++) {
+        if (pch->compilers[i].adapter == adapter) {
+            hr_hash128_t id = pch->compilers[i].id;
+            hr_platform_mutex_unlock(pch->lock);
+            return id;
+        }
+    }
+    hr_platform_mutex_unlock(pch->lock);
+
+    hr_hasher_t h;
+    hr_hash_init(&h, HR_PCH_VERSION);
+    hr_hash_str(&h, adapter->compiler);
+    char path[4096];
+    if (adapter->compiler && hr_platform_find_program(adapter->compiler, path, sizeof(path))) {
+        hr_hash_str(&h, path);
+        hr_hash_u64(&h, (uint64_t)hr_platform_file_size(path));
+        hr_hash_u64(&h, (uint64_t)hr_platform_file_mtime(path));
+    }
+    hr_hash128_t id = hr_hash_final(&h);
+
+    hr_platform_mutex_lock(pch->lock);
+    if (pch->compiler_count < HR_PCH_MAX_COMPILERS) {
+        pch->compilers[pch->compiler_count].adapter = adapter;
+        pch->compilers[pch->compiler_count].id      = id;
+        pch->compiler_count++;
+    }
+    hr_platform_mutex_unlock(pch->lock);
+    return id;
+}
+
+static char* read_file(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* buf = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    if (buf) {
+        *len = fread(buf, 1, (size_t)size, f);
+        buf[*len] = 0;
+    }
+    fclose(f);
+    return buf;
+}
+
+static const char* skip_blank(const char* p) {
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == '\f' || *p == '\v') p++;
+        if (p[0] == '/' && p[1] == '/') {
+            while (*p && *p != '\n') p++;
+        } else if (p[0] == '/' && p[1] == '*') {
+            const char* end = strstr(p + 2, "*/");
+            if (!end) return p + strlen(p);
+            p = end + 2;
+        } else {
+            return p;
+        }
+    }
+}
+
+static int directive(const char** pp, const char* name) {
+    const char* p = *pp + 1;
+    while (*p == ' ' || *p == '\t') p++;
+    size_t len = strlen(name);
+    if (strncmp(p, name, len) != 0) return 0;
+    p += len;
+    if (*p != ' ' && *p != '\t' && *p != '<' && *p != '"') return 0;
+    while (*p == ' ' || *p == '\t') p++;
+    *pp = p;
+    return 1;
+}
+
+/* The prefix is the run of #include lines at the top of the file, before any
+   other code or directive; only that part can be replayed from a PCH. */
+static size_t extract_prefix(const char* text, char* out, size_t out_size) {
+    size_t n = 0;
+    const char* p = skip_blank(text);
+    while (*p == '#') {
+        const char* arg = p;
+        if (directive(&arg, "pragma") && strncmp(arg, "once", 4) == 0) {
+            while (*p && *p != '\n') p++;
+            p = skip_blank(p);
+            continue;
+        }
+        arg = p;
+        if (!directive(&arg, "include") || (*arg != '<' && *arg != '"')) break;
+        char close = *arg == '<' ? '>' : '"';
+        const char* end = strchr(arg + 1, close);
+        const char* eol = strchr(arg, '\n');
+        if (!end || (eol && end > eol)) break;
+        size_t len = (size_t)(end - arg + 1);
+        if (n + len + 11 >= out_size) break;
+        memcpy(out + n, "#include ", 9);
+        memcpy(out + n + 9, arg, len);
+        n += 9 + len;
+        out[n++] = '\n';
+        p = skip_blank(end + 1);
+    }
+    out[n] = 0;
+    return n;
+}
+
+static int stamp_valid(const char* stamp_path) {
+    size_t len = 0;
+    char*  text = read_file(stamp_path, &len);
+    if (!text) return 0;
+    int valid = len > 0;
+    char* save = NULL;
+    for (char* line = strtok_r(text, "\n", &save); line && valid; line = strtok_r(NULL, "\n", &save)) {
+        hr_hash128_t want, have;
+        valid = strlen(line) > 33 && line[32] == ' ' && hr_hash_parse(line, &want) &&
+                hr_hash_file(line + 33, &have) && hr_hash_equal(want, have);
+    }
+    free(text);
+    return valid;
+}
+
+static int write_stamp(const char* tmp, const char* stamp_path, const hr_dep_list_t* deps) {
+    FILE* f = fopen(tmp, "wb");
+    if (!f) return 0;
+    int ok = 1;
+    for (int i = 0; i < deps->count && ok; i++) {
+        hr_hash128_t hash;
+        char hex[33];
+        ok = hr_hash_file(deps->paths[i], &hash);
+        hr_hash_hex(hash, hex);
+        fprintf(f, "%s %s\n", hex, deps->paths[i]);
+    }
+    if (fclose(f) != 0 || !ok || !hr_platform_rename(tmp, stamp_path)) {
+        remove(tmp);
+        return 0;
+    }
+    return 1;
+}
+
+static void temp_path(hr_pch_t* pch, const char* suffix, char* out, size_t out_sz) {
+    hr_platform_mutex_lock(pch->lock);
+    unsigned n = pch->tmp_counter++;
+    hr_platform_mutex_unlock(pch->lock);
+    snprintf(out, out_sz, "%s/tmp.%d.%u%s", pch->dir, hr_platform_process_id(), n, suffix);
+}
+
+static int build(hr_pch_t* pch, const hr_adapter_t* adapter, const char* header, const char* gch,
+                 const char* stamp, const char* prefix, const char* flags) {
+    char header_tmp[4096 + 40], gch_tmp[4096 + 40], dep_tmp[4096 + 42], stamp_tmp[4096 + 40];
+    temp_path(pch, ".h", header_tmp, sizeof(header_tmp));
+    temp_path(pch, ".gch", gch_tmp, sizeof(gch_tmp));
+    snprintf(dep_tmp, sizeof(dep_tmp), "%s.d", gch_tmp);
+    temp_path(pch, ".stamp", stamp_tmp, sizeof(stamp_tmp));
+
+    if (!hr_platform_file_exists(header)) {
+        FILE* f = fopen(header_tmp, "wb");
+        if (!f) return 0;
+        fputs(prefix, f);
+        if (fclose(f) != 0 || !hr_platform_rename(header_tmp, header)) {
+            remove(header_tmp);
+            return 0;
+        }
+    }
+
+    hr_process_result_t result;
+    int ok = adapter->compile_pch(adapter, header, gch_tmp, flags, &result);
+    hr_platform_process_result_free(&result);
+
+    hr_dep_list_t deps;
+    hr_deps_init(&deps);
+    if (ok) ok = hr_deps_parse_file(dep_tmp, &deps) && deps.count > 0;
+    if (ok) ok = hr_platform_rename(gch_tmp, gch) && write_stamp(stamp_tmp, stamp, &deps);
+    remove(dep_tmp);
+    remove(gch_tmp);
+    hr_deps_free(&deps);
+    return ok;
+}
+
+int hr_pch_prepare(hr_pch_t* pch, const hr_adapter_t* adapter, const char* src_path,
+                   const char* flags, volatile int* cancel, char* out_flags, size_t out_size) {
+    if (!pch || !adapter->compile_pch) return 0;
+
+    char src[4096];
+    if (!hr_platform_realpath(src_path, src, sizeof(src))) return 0;
+    size_t len = 0;
+    char*  text = read_file(src, &len);
+    if (!text) return 0;
+    char prefix[HR_PCH_MAX_PREFIX];
+    size_t prefix_len = extract_prefix(text, prefix, sizeof(prefix));
+    free(text);
+    if (prefix_len == 0) return 0;
+
+    char src_dir[4096];
+    strncpy(src_dir, src, sizeof(src_dir)-1);
+    src_dir[sizeof(src_dir)-1] = 0;
+    char* slash = strrchr(src_dir, '/');
+    if (!slash) slash = strrchr(src_dir, '\\');
+    if (slash) *slash = 0;
+
+    char pch_flags[8192];
+    snprintf(pch_flags, sizeof(pch_flags), "%s -iquote \"%s\"", flags ? flags : "", src_dir);
+
+    hr_hash128_t compiler = compiler_identity(pch, adapter);
+    hr_hasher_t h;
+    hr_hash_init(&h, HR_PCH_VERSION);
+    hr_hash_str(&h, hr_platform_name());
+    hr_hash_str(&h, adapter->name);
+    hr_hash_u64(&h, compiler.lo);
+    hr_hash_u64(&h, compiler.hi);
+    hr_hash_str(&h, pch_flags);
+    hr_hash_str(&h, prefix);
+    char hex[33];
+    hr_hash_hex(hr_hash_final(&h), hex);
+
+    char header[4096 + 40], gch[4096 + 48], stamp[4096 + 48], lock[4096 + 48];
+    snprintf(header, sizeof(header), "%s/%s.h", pch->dir, hex);
+    snprintf(gch, sizeof(gch), "%s.gch", header);
+    snprintf(stamp, sizeof(stamp), "%s/%s.stamp", pch->dir, hex);
+    snprintf(lock, sizeof(lock), "%s/.%s.lock", pch->dir, hex);
+
+    int hit = 0, built = 0;
+    for (;;) {
+        if (stamp_valid(stamp) && hr_platform_file_exists(gch)) { hit = 1; break; }
+        hr_file_lock_t* held = hr_platform_file_trylock(lock);
+        if (held) {
+            if (stamp_valid(stamp) && hr_platform_file_exists(gch)) hit = 1;
+            else built = build(pch, adapter, header, gch, stamp, prefix, pch_flags);
+            hr_platform_file_unlock(held);
+            break;
+        }
+        if (cancel && *cancel) break;
+        hr_platform_sleep_ms(HR_PCH_WAIT_MS);
+    }
+
+    hr_platform_mutex_lock(pch->lock);
+    if (hit)        pch->stats.hits++;
+    else            pch->stats.misses++;
+    if (!hit && !built && !(cancel && *cancel)) pch->stats.failures++;
+    hr_platform_mutex_unlock(pch->lock);
+
+    if (!hit && !built) return 0;
+    snprintf(out_flags, out_size, "%s -include \"%s\" -fpch-deps", pch_flags, header);
+    return 1;
+}
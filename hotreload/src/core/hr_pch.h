@@ -0,0 +1,21 @@
+#ifndef HR_PCH_H
+#define HR_PCH_H
+
+#include "../adapters/hr_adapter.h"
+#include <stdint.h>
+
+typedef struct hr_pch hr_pch_t;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t failures;
+} hr_pch_stats_t;
+
+hr_pch_t* hr_pch_open(const char* build_dir);
+void      hr_pch_close(hr_pch_t* pch);
+int       hr_pch_prepare(hr_pch_t* pch, const hr_adapter_t* adapter, const char* src_path,
+                         const char* flags, volatile int* cancel, char* out_flags, size_t out_size);
+void      hr_pch_get_stats(hr_pch_t* pch, hr_pch_stats_t* out);
+
+#endif
@@ -0,0 +1,200 @@
+#include "hr_reclaim.h"
+#include "../platform/hr_platform.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HR_THREAD_LOCAL __declspec(thread)
+#define atomic_load(p)        (*(volatile uint64_t*)(p))
+#define atomic_store(p, v)    (*(volatile uint64_t*)(p) = (v))
+#define atomic_bump(p)        ((uint64_t)_InterlockedIncrement64((volatile long long*)(p)))
+#define atomic_claim(p)       (_InterlockedCompareExchange((volatile long*)(p), 1, 0) == 0)
+#define atomic_release(p)     _InterlockedExchange((volatile long*)(p), 0)
+#define atomic_fence()        MemoryBarrier()
+#else
+#define HR_THREAD_LOCAL _Thread_local
+#define atomic_load(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define atomic_store(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define atomic_bump(p)        __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define atomic_claim(p)       __extension__({ long _zero = 0; \
+                                  __atomic_compare_exchange_n((p), &_zero, 1, 0, \
+                                      __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); })
+#define atomic_release(p)     __atomic_store_n((p), 0, __ATOMIC_SEQ_CST)
+#define atomic_fence()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#define HR_MAX_READERS 1024
+#define HR_RECLAIM_POLL_MS 1
+
+typedef struct {
+    volatile long     used;
+    volatile uint64_t seen;
+} reader_t;
+
+static reader_t          g_readers[HR_MAX_READERS];
+static volatile uint64_t g_epoch = 1;
+static HR_THREAD_LOCAL reader_t* t_reader;
+
+typedef struct retired {
+    hr_reclaim_fn   fn;
+    void*           item;
+    uint64_t        epoch;
+    struct retired* next;
+} retired_t;
+
+struct hr_reclaimer {
+    hr_mutex_t*  lock;
+    hr_cond_t*   wake;
+    hr_thread_t* thread;
+    retired_t*   pending;
+    int          pending_count;
+    uint64_t     released;
+    int          stopping;
+};
+
+int hr_reclaim_register(void) {
+    if (t_reader) return 1;
+    for (int i = 0; i < HR_MAX_READERS; i++) {
+        if (g_readers[i].used || !atomic_claim(&g_readers[i].used)) continue;
+        atomic_store(&g_readers[i].seen, atomic_load(&g_epoch));
+        atomic_fence();
+        t_reader = &g_readers[i];
+        return 1;
+    }
+    return 0;
+}
+
+void hr_reclaim_unregister(void) {
+    if (!t_reader) return;
+    atomic_release(&t_reader->used);
+    t_reader = NULL;
+}
+
+/* Everything the thread did in module code before this point happens
+   before the store. */
+void hr_reclaim_quiescent(void) {
+    reader_t* r = t_reader;
+    if (r) atomic_store(&r->seen, atomic_load(&g_epoch));
+}
+
+/* The oldest epoch some registered thread may still be running in. */
+static uint64_t oldest_seen(void) {
+    uint64_t oldest = UINT64_MAX;
+    atomic_fence();
+    for (int i = 0; i < HR_MAX_READERS; i++) {
+        if (!g_readers[i].used) continue;
+        uint64_t seen = atomic_load(&g_readers[i].seen);
+        if (seen < oldest) oldest = seen;
+    }
+    return oldest;
+}
+
+/* Detaches the items every registered thread has moved past. */
+static retired_t* take_safe(hr_reclaimer_t* r, uint64_t oldest) {
+    retired_t* safe = NULL;
+    retired_t** link = &r->pending;
+    while (*link) {
+        retired_t* item = *link;
+        if (item->epoch <= oldest) {
+            *link = item->next;
+            item->next = safe;
+            safe = item;
+            r->pending_count--;
+        } else {
+            link = &item->next;
+        }
+    }
+    return safe;
+}
+
+static void release_all(hr_reclaimer_t* r, retired_t* list) {
+    int count = 0;
+    while (list) {
+        retired_t* next = list->next;
+        list->fn(list->item);
+        free(list);
+        list = next;
+        count++;
+    }
+    hr_platform_mutex_lock(r->lock);
+    r->released += (uint64_t)count;
+    hr_platform_mutex_unlock(r->lock);
+}
+
+static void reclaim_main(void* arg) {
+    hr_reclaimer_t* r = (hr_reclaimer_t*)arg;
+    hr_platform_mutex_lock(r->lock);
+    for (;;) {
+        while (!r->pending && !r->stopping)
+            hr_platform_cond_wait(r->wake, r->lock);
+        if (r->stopping) break;
+        retired_t* safe = take_safe(r, oldest_seen());
+        hr_platform_mutex_unlock(r->lock);
+        if (safe) release_all(r, safe);
+        else      hr_platform_sleep_ms(HR_RECLAIM_POLL_MS);
+        hr_platform_mutex_lock(r->lock);
+    }
+    hr_platform_mutex_unlock(r->lock);
+}
+
+hr_reclaimer_t* hr_reclaim_create(void) {
+    hr_reclaimer_t* r = calloc(1, sizeof(hr_reclaimer_t));
+    if (!r) return NULL;
+    r->lock = hr_platform_mutex_create();
+    r->wake = hr_platform_cond_create();
+    if (r->lock && r->wake) r->thread = hr_platform_thread_start(reclaim_main, r);
+    if (!r->thread) {
+        if (r->wake) hr_platform_cond_destroy(r->wake);
+        if (r->lock) hr_platform_mutex_destroy(r->lock);
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+void hr_reclaim_destroy(hr_reclaimer_t* r) {
+    if (!r) return;
+    hr_platform_mutex_lock(r->lock);
+    r->stopping = 1;
+    hr_platform_cond_broadcast(r->wake);
+    hr_platform_mutex_unlock(r->lock);
+    hr_platform_thread_join(r->thread);
+    release_all(r, take_safe(r, UINT64_MAX));
+    hr_platform_cond_destroy(r->wake);
+    hr_platform_mutex_destroy(r->lock);
+    free(r);
+}
+
+/* The epoch is bumped after the item is unreachable for new callers; a
+   thread quiescent in the new epoch can no longer be inside it. */
+void hr_reclaim_retire(hr_reclaimer_t* r, hr_reclaim_fn fn, void* item) {
+    retired_t* entry = malloc(sizeof(retired_t));
+    if (!entry) {
+        fprintf(stderr, "[hr:reclaim] out of memory, leaking a retired generation\n");
+        return;
+    }
+    entry->fn    = fn;
+    entry->item  = item;
+    entry->epoch = atomic_bump(&g_epoch);
+    hr_platform_mutex_lock(r->lock);
+    entry->next = r->pending;
+    r->pending  = entry;
+    r->pending_count++;
+    hr_platform_cond_broadcast(r->wake);
+    hr_platform_mutex_unlock(r->lock);
+}
+
+int hr_reclaim_pending(hr_reclaimer_t* r) {
+    hr_platform_mutex_lock(r->lock);
+    int count = r->pending_count;
+    hr_platform_mutex_unlock(r->lock);
+    return count;
+}
+
+uint64_t hr_reclaim_released(hr_reclaimer_t* r) {
+    hr_platform_mutex_lock(r->lock);
+    uint64_t released = r->released;
+    hr_platform_mutex_unlock(r->lock);
+    return released;
+}
@@ -0,0 +1,26 @@
+#ifndef HR_RECLAIM_H
+#define HR_RECLAIM_H
+
+#include <stdint.h>
+
+/* Quiescent-state based reclamation. Threads that may run module code
+   register once and call hr_reclaim_quiescent whenever they hold no pointer
+   into it; a retired item is released by a background thread once every
+   registered thread has been quiescent since it was retired. Thread records
+   are process-wide, so one registration covers every context. */
+typedef struct hr_reclaimer hr_reclaimer_t;
+typedef void (*hr_reclaim_fn)(void* item);
+
+int             hr_reclaim_register(void);
+void            hr_reclaim_unregister(void);
+void            hr_reclaim_quiescent(void);
+
+hr_reclaimer_t* hr_reclaim_create(void);
+/* Releases everything still pending without waiting: the caller
+   guarantees no thread runs module code any more. */
+void            hr_reclaim_destroy(hr_reclaimer_t* r);
+void            hr_reclaim_retire(hr_reclaimer_t* r, hr_reclaim_fn fn, void* item);
+int             hr_reclaim_pending(hr_reclaimer_t* r);
+uint64_t        hr_reclaim_released(hr_reclaimer_t* r);
+
+#endif
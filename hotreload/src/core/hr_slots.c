@@ -0,0 +1,67 @@
+#include "hr_slots.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void slot_store(hr_fn_slot_t* slot, void* fn) {
+#if defined(_MSC_VER)
+    *(void* volatile*)&slot->fn = fn;
+#else
+    __atomic_store_n(&slot->fn, fn, __ATOMIC_RELEASE);
+#endif
+}
+
+void hr_slots_init(hr_slot_list_t* list) {
+    list->head  = NULL;
+    list->count = 0;
+}
+
+void hr_slots_free(hr_slot_list_t* list) {
+    hr_slot_block_t* b = list->head;
+    while (b) {
+        hr_slot_block_t* next = b->next;
+        for (int i = 0; i < b->used; i++)
+            free((char*)b->slots[i].name);
+        free(b);
+        b = next;
+    }
+    hr_slots_init(list);
+}
+
+hr_fn_slot_t* hr_slots_find(hr_slot_list_t* list, const char* name) {
+    for (hr_slot_block_t* b = list->head; b; b = b->next) {
+        for (int i = 0; i < b->used; i++) {
+            if (strcmp(b->slots[i].name, name) == 0)
+                return &b->slots[i];
+        }
+    }
+    return NULL;
+}
+
+hr_fn_slot_t* hr_slots_bind(hr_slot_list_t* list, const char* name, void* addr) {
+    hr_fn_slot_t* slot = hr_slots_find(list, name);
+    if (slot) return slot;
+
+    hr_slot_block_t* b = list->head;
+    if (!b || b->used >= HR_SLOTS_PER_BLOCK) {
+        b = calloc(1, sizeof(hr_slot_block_t));
+        if (!b) return NULL;
+        b->next    = list->head;
+        list->head = b;
+    }
+
+    char* owned = strdup(name);
+    if (!owned) return NULL;
+
+    slot = &b->slots[b->used++];
+    slot->name = owned;
+    slot_store(slot, addr);
+    list->count++;
+    return slot;
+}
+
+void hr_slots_rebind(hr_slot_list_t* list, hr_slot_resolve_fn resolve, void* userdata) {
+    for (hr_slot_block_t* b = list->head; b; b = b->next) {
+        for (int i = 0; i < b->used; i++)
+            slot_store(&b->slots[i], resolve(userdata, b->slots[i].name));
+    }
+}
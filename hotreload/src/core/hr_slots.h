@@ -0,0 +1,27 @@
+#ifndef HR_SLOTS_H
+#define HR_SLOTS_H
+
+#include "../../include/hotreload.h"
+
+#define HR_SLOTS_PER_BLOCK 32
+
+typedef void* (*hr_slot_resolve_fn)(void* userdata, const char* name);
+
+typedef struct hr_slot_block {
+    hr_fn_slot_t          slots[HR_SLOTS_PER_BLOCK];
+    int                   used;
+    struct hr_slot_block* next;
+} hr_slot_block_t;
+
+typedef struct {
+    hr_slot_block_t* head;
+    int              count;
+} hr_slot_list_t;
+
+void          hr_slots_init(hr_slot_list_t* list);
+void          hr_slots_free(hr_slot_list_t* list);
+hr_fn_slot_t* hr_slots_find(hr_slot_list_t* list, const char* name);
+hr_fn_slot_t* hr_slots_bind(hr_slot_list_t* list, const char* name, void* addr);
+void          hr_slots_rebind(hr_slot_list_t* list, hr_slot_resolve_fn resolve, void* userdata);
+
+#endif
@@ -1,31 +1,152 @@
 #include "hr_symbols.h"
+#include "hr_hash.h"
 #include <string.h>
 #include <stdlib.h>
 
+#define HR_NAME_BLOCK_SIZE 4096
+#define HR_MIN_BUCKETS     16
+
+struct hr_name_block {
+    struct hr_name_block* next;
+    size_t                size;
+    size_t                used;
+    char                  data[];
+};
+
+static const char* intern_name(hr_symbol_table_t* table, const char* name) {
+    size_t len = strlen(name) + 1;
+    hr_name_block_t* b = table->names;
+    if (!b || b->size - b->used < len) {
+        size_t size = len > HR_NAME_BLOCK_SIZE ? len : HR_NAME_BLOCK_SIZE;
+        b = malloc(sizeof(hr_name_block_t) + size);
+        if (!b) return NULL;
+        b->next      = table->names;
+        b->size      = size;
+        b->used      = 0;
+        table->names = b;
+    }
+    char* dst = b->data + b->used;
+    memcpy(dst, name, len);
+    b->used += len;
+    return dst;
+}
+
+static void free_names(hr_name_block_t* b) {
+    while (b) {
+        hr_name_block_t* next = b->next;
+        free(b);
+        b = next;
+    }
+}
+
+static void insert_bucket(hr_symbol_table_t* table, int index) {
+    uint32_t mask = (uint32_t)table->bucket_count - 1;
+    uint32_t i    = (uint32_t)table->entries[index].hash & mask;
+    while (table->buckets[i] >= 0)
+        i = (i + 1) & mask;
+    table->buckets[i] = index;
+}
+
+static int rehash(hr_symbol_table_t* table, int bucket_count) {
+    int32_t* buckets = malloc(sizeof(int32_t) * (size_t)bucket_count);
+    if (!buckets) return 0;
+    memset(buckets, 0xFF, sizeof(int32_t) * (size_t)bucket_count);
+    free(table->buckets);
+    table->buckets      = buckets;
+    table->bucket_count = bucket_count;
+    for (int i = 0; i < table->count; i++)
+        insert_bucket(table, i);
+    return 1;
+}
+
 void hr_symbols_init(hr_symbol_table_t* table) {
     memset(table, 0, sizeof(*table));
 }
 
 void hr_symbols_clear(hr_symbol_table_t* table) {
     table->count = 0;
+    if (table->buckets)
+        memset(table->buckets, 0xFF, sizeof(int32_t) * (size_t)table->bucket_count);
+    if (table->names) {
+        free_names(table->names->next);
+        table->names->next = NULL;
+        table->names->used = 0;
+    }
 }
 
-hr_symbol_t* hr_symbols_find(hr_symbol_table_t* table, const char* name) {
-    for (int i = 0; i < table->count; i++) {
-        if (strcmp(table->entries[i].name, name) == 0)
-            return &table->entries[i];
+void hr_symbols_free(hr_symbol_table_t* table) {
+    free(table->entries);
+    free(table->buckets);
+    free_names(table->names);
+    hr_symbols_init(table);
+}
+
+int hr_symbols_reserve(hr_symbol_table_t* table, int count) {
+    if (count > table->capacity) {
+        hr_symbol_t* entries = realloc(table->entries, sizeof(hr_symbol_t) * (size_t)count);
+        if (!entries) return 0;
+        table->entries  = entries;
+        table->capacity = count;
+    }
+    int buckets = table->bucket_count ? table->bucket_count : HR_MIN_BUCKETS;
+    while (buckets < count * 2) buckets *= 2;
+    if (buckets != table->bucket_count)
+        return rehash(table, buckets);
+    return 1;
+}
+
+uint64_t hr_symbols_hash(const char* name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        hash ^= (uint64_t)*p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+hr_symbol_t* hr_symbols_find_hashed(hr_symbol_table_t* table, const char* name, uint64_t hash) {
+    if (table->count == 0) return NULL;
+    uint32_t mask = (uint32_t)table->bucket_count - 1;
+    for (uint32_t i = (uint32_t)hash & mask; table->buckets[i] >= 0; i = (i + 1) & mask) {
+        hr_symbol_t* sym = &table->entries[table->buckets[i]];
+        if (sym->hash == hash && strcmp(sym->name, name) == 0)
+            return sym;
     }
     return NULL;
 }
 
+hr_symbol_t* hr_symbols_find(hr_symbol_table_t* table, const char* name) {
+    return hr_symbols_find_hashed(table, name, hr_symbols_hash(name));
+}
+
 hr_symbol_t* hr_symbols_add(hr_symbol_table_t* table, const char* name, void* addr) {
-    if (table->count >= HR_MAX_SYMBOLS) return NULL;
-    hr_symbol_t* sym = &table->entries[table->count++];
-    strncpy(sym->name, name, HR_MAX_NAME - 1);
+    uint64_t hash = hr_symbols_hash(name);
+    hr_symbol_t* sym = hr_symbols_find_hashed(table, name, hash);
+    if (sym) {
+        sym->current_addr = addr;
+        sym->checksum     = 0;
+        return sym;
+    }
+
+    if (table->count >= table->capacity || table->bucket_count < (table->count + 1) * 2) {
+        int want = table->capacity ? table->capacity * 2 : HR_MIN_BUCKETS;
+        if (!hr_symbols_reserve(table, want)) return NULL;
+    }
+
+    const char* interned = intern_name(table, name);
+    if (!interned) return NULL;
+
+    int index = table->count++;
+    sym = &table->entries[index];
+    sym->name          = interned;
+    sym->hash          = hash;
     sym->current_addr  = addr;
     sym->original_addr = addr;
-    sym->checksum      = hr_symbols_checksum_fn(addr, 64);
+    sym->size          = 0;
+    sym->checksum      = 0;
+    sym->type          = HR_SYM_UNKNOWN;
     sym->patched       = 0;
+    insert_bucket(table, index);
     return sym;
 }
 
@@ -33,19 +154,27 @@ void hr_symbols_update(hr_symbol_table_t* table, const char* name, void* new_add
     hr_symbol_t* sym = hr_symbols_find(table, name);
     if (sym) {
         sym->current_addr = new_addr;
-        sym->checksum     = hr_symbols_checksum_fn(new_addr, 64);
+        sym->checksum     = 0;
     } else {
         hr_symbols_add(table, name, new_addr);
     }
 }
 
-uint64_t hr_symbols_checksum_fn(void* addr, size_t len) {
-    if (!addr) return 0;
-    uint64_t hash = 14695981039346656037ULL;
-    unsigned char* p = (unsigned char*)addr;
-    for (size_t i = 0; i < len; i++) {
-        hash ^= (uint64_t)p[i];
-        hash *= 1099511628211ULL;
-    }
-    return hash;
+size_t hr_symbols_memory(const hr_symbol_table_t* table) {
+    size_t total = sizeof(hr_symbol_t) * (size_t)table->capacity +
+                   sizeof(int32_t) * (size_t)table->bucket_count;
+    for (const hr_name_block_t* b = table->names; b; b = b->next)
+        total += sizeof(hr_name_block_t) + b->size;
+    return total;
+}
+
+/* Hashes a function's machine code over its exact size. Zero means the size
+   is unknown and the function cannot be compared. */
+uint64_t hr_symbols_checksum_fn(const void* addr, size_t len) {
+    if (!addr || len == 0) return 0;
+    hr_hasher_t h;
+    hr_hash_init(&h, len);
+    hr_hash_update(&h, addr, len);
+    uint64_t hash = hr_hash_final(&h).lo;
+    return hash ? hash : 1;
 }
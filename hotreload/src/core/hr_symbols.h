@@ -4,27 +4,44 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#define HR_MAX_SYMBOLS 512
-#define HR_MAX_NAME    256
+typedef enum {
+    HR_SYM_UNKNOWN = 0,
+    HR_SYM_FUNC,
+    HR_SYM_IFUNC
+} hr_symbol_type_t;
 
 typedef struct {
-    char     name[HR_MAX_NAME];
-    void*    current_addr;
-    void*    original_addr;
-    uint64_t checksum;
-    int      patched;
+    const char*      name;
+    uint64_t         hash;
+    void*            current_addr;
+    void*            original_addr;
+    uint64_t         size;
+    uint64_t         checksum;
+    hr_symbol_type_t type;
+    int              patched;
 } hr_symbol_t;
 
+typedef struct hr_name_block hr_name_block_t;
+
 typedef struct {
-    hr_symbol_t entries[HR_MAX_SYMBOLS];
-    int         count;
+    hr_symbol_t*     entries;
+    int32_t*         buckets;
+    int              count;
+    int              capacity;
+    int              bucket_count;
+    hr_name_block_t* names;
 } hr_symbol_table_t;
 
 void         hr_symbols_init(hr_symbol_table_t* table);
 void         hr_symbols_clear(hr_symbol_table_t* table);
+void         hr_symbols_free(hr_symbol_table_t* table);
+int          hr_symbols_reserve(hr_symbol_table_t* table, int count);
+uint64_t     hr_symbols_hash(const char* name);
 hr_symbol_t* hr_symbols_find(hr_symbol_table_t* table, const char* name);
+hr_symbol_t* hr_symbols_find_hashed(hr_symbol_table_t* table, const char* name, uint64_t hash);
 hr_symbol_t* hr_symbols_add(hr_symbol_table_t* table, const char* name, void* addr);
 void         hr_symbols_update(hr_symbol_table_t* table, const char* name, void* new_addr);
-uint64_t     hr_symbols_checksum_fn(void* addr, size_t len);
+size_t       hr_symbols_memory(const hr_symbol_table_t* table);
+uint64_t     hr_symbols_checksum_fn(const void* addr, size_t len);
 
 #endif
@@ -0,0 +1,241 @@
+#include "hr_toolchain.h"
+#include "hr_hash.h"
+#include "../adapters/hr_adapter.h"
+#include "../adapters/hr_cmd.h"
+#include "../platform/hr_platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HR_TOOLCHAIN_VERSION 1
+
+typedef struct {
+    const char* name;
+    const char* flag;
+    const char* programs[3];
+} hr_linker_info_t;
+
+static const hr_linker_info_t linkers[HR_LINKER_COUNT] = {
+    [HR_LINKER_SYSTEM] = { "system", NULL,             { NULL } },
+    [HR_LINKER_GOLD]   = { "gold",   "-fuse-ld=gold",  { "ld.gold", NULL } },
+    [HR_LINKER_LLD]    = { "lld",    "-fuse-ld=lld",   { "ld.lld", NULL } },
+    [HR_LINKER_MOLD]   = { "mold",   "-fuse-ld=mold",  { "ld.mold", "mold", NULL } },
+};
+
+static const hr_linker_t preference[] = { HR_LINKER_MOLD, HR_LINKER_LLD, HR_LINKER_GOLD };
+
+static void hash_program(hr_hasher_t* h, const char* name) {
+    char path[4096];
+    hr_hash_str(h, name);
+    if (!hr_platform_find_program(name, path, sizeof(path))) return;
+    hr_hash_str(h, path);
+    hr_hash_u64(h, (uint64_t)hr_platform_file_size(path));
+    hr_hash_u64(h, (uint64_t)hr_platform_file_mtime(path));
+}
+
+/* Identifies everything the probe result depends on: the candidate programs
+   found on PATH, their size and date. */
+static void fingerprint(char hex[33]) {
+    hr_hasher_t h;
+    hr_hash_init(&h, HR_TOOLCHAIN_VERSION);
+    hr_hash_str(&h, hr_platform_name());
+    for (int lang = HR_LANG_C; lang <= HR_LANG_GO; lang++) {
+        hr_adapter_t* adapter = hr_adapter_get((hr_lang_t)lang);
+        if (!adapter) continue;
+        hr_hash_str(&h, adapter->name);
+        for (int i = 0; adapter->compilers && adapter->compilers[i]; i++)
+            hash_program(&h, adapter->compilers[i]);
+    }
+    for (int l = 0; l < HR_LINKER_COUNT; l++)
+        for (int i = 0; linkers[l].programs[i]; i++)
+            hash_program(&h, linkers[l].programs[i]);
+    hr_hash_hex(hr_hash_final(&h), hex);
+}
+
+static void first_line(const char* text, size_t len, char* out, size_t out_size) {
+    while (len > 0 && (*text == ' ' || *text == '\n' || *text == '\r')) { text++; len--; }
+    size_t n = 0;
+    while (n < len && n + 1 < out_size && text[n] != '\n' && text[n] != '\r') {
+        out[n] = text[n] == '\t' ? ' ' : text[n];
+        n++;
+    }
+    out[n] = 0;
+}
+
+static void probe_lang(hr_adapter_t* adapter, hr_toolchain_t* tc) {
+    memset(tc, 0, sizeof(*tc));
+    tc->lang = adapter->lang;
+    char path[4096];
+    for (int i = 0; adapter->compilers && adapter->compilers[i]; i++) {
+        if (!hr_platform_find_program(adapter->compilers[i], path, sizeof(path))) continue;
+        tc->available = 1;
+        strncpy(tc->compiler, adapter->compilers[i], sizeof(tc->compiler)-1);
+        break;
+    }
+    if (!tc->available) return;
+
+    hr_cmd_t cmd;
+    hr_process_result_t result;
+    hr_cmd_init(&cmd, tc->compiler);
+    hr_cmd_arg(&cmd, adapter->version_arg ? adapter->version_arg : "--version");
+    if (hr_cmd_run(&cmd, &result) == 0)
+        first_line(result.out, result.out_len, tc->version, sizeof(tc->version));
+    hr_platform_process_result_free(&result);
+}
+
+static int try_linker(const char* compiler, const char* dir, const hr_linker_info_t* linker) {
+    int found = 0;
+    char path[4096];
+    for (int i = 0; linker->programs[i] && !found; i++)
+        found = hr_platform_find_program(linker->programs[i], path, sizeof(path));
+    if (!found) return 0;
+
+    char src[4096 + 32], out[4096 + 32];
+    snprintf(src, sizeof(src), "%s/probe.%d.c", dir, hr_platform_process_id());
+    snprintf(out, sizeof(out), "%s/probe.%d%s", dir, hr_platform_process_id(), hr_platform_lib_ext());
+    FILE* f = fopen(src, "wb");
+    if (!f) return 0;
+    fputs("int hr_probe(void) { return 0; }\n", f);
+    if (fclose(f) != 0) return 0;
+
+    hr_cmd_t cmd;
+    hr_process_result_t result;
+    hr_cmd_init(&cmd, compiler);
+    hr_cmd_args(&cmd, "-shared", "-fPIC", linker->flag, src, "-o", out, NULL);
+    int ok = hr_cmd_run(&cmd, &result) == 0;
+    hr_platform_process_result_free(&result);
+    remove(out);
+    remove(src);
+    return ok;
+}
+
+static int load_cache(const char* path, const char* key, hr_toolchain_probe_t* out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    char line[1024];
+    int  version = 0;
+    char stored[64] = {0};
+    int  ok = fgets(line, sizeof(line), f) &&
+              sscanf(line, "hr-toolchain %d %63s", &version, stored) == 2 &&
+              version == HR_TOOLCHAIN_VERSION && strcmp(stored, key) == 0 &&
+              fgets(line, sizeof(line), f) && sscanf(line, "linkers %u", &out->linkers) == 1;
+    while (ok && out->count < HR_TOOLCHAIN_MAX_LANGS && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+        char* compiler = strchr(line, '\t');
+        char* version_str = compiler ? strchr(compiler + 1, '\t') : NULL;
+        if (!version_str) { ok = 0; break; }
+        *compiler++ = 0;
+        *version_str++ = 0;
+        hr_toolchain_t* tc = &out->langs[out->count++];
+        memset(tc, 0, sizeof(*tc));
+        tc->lang      = (hr_lang_t)atoi(line);
+        tc->available = compiler[0] != 0;
+        strncpy(tc->compiler, compiler, sizeof(tc->compiler)-1);
+        strncpy(tc->version, version_str, sizeof(tc->version)-1);
+    }
+    fclose(f);
+    if (!ok) {
+        out->count   = 0;
+        out->linkers = 0;
+    }
+    return ok;
+}
+
+static void store_cache(const char* path, const char* key, const hr_toolchain_probe_t* probe) {
+    char tmp[4096 + 48];
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, hr_platform_process_id());
+    FILE* f = fopen(tmp, "wb");
+    if (!f) return;
+    fprintf(f, "hr-toolchain %d %s\nlinkers %u\n", HR_TOOLCHAIN_VERSION, key, probe->linkers);
+    for (int i = 0; i < probe->count; i++) {
+        const hr_toolchain_t* tc = &probe->langs[i];
+        fprintf(f, "%d\t%s\t%s\n", (int)tc->lang, tc->compiler, tc->version);
+    }
+    if (fclose(f) != 0 || !hr_platform_rename(tmp, path))
+        remove(tmp);
+}
+
+int hr_toolchain_probe(const char* build_dir, hr_toolchain_probe_t* out) {
+    memset(out, 0, sizeof(*out));
+    uint64_t start = hr_platform_time_ns();
+    char key[33], path[4096 + 32];
+    fingerprint(key);
+    snprintf(path, sizeof(path), "%s/toolchain.cache", build_dir);
+    if (load_cache(path, key, out)) {
+        out->from_cache = 1;
+        out->probe_ns   = hr_platform_time_ns() - start;
+        return 1;
+    }
+
+    for (int lang = HR_LANG_C; lang <= HR_LANG_GO && out->count < HR_TOOLCHAIN_MAX_LANGS; lang++) {
+        hr_adapter_t* adapter = hr_adapter_get((hr_lang_t)lang);
+        if (adapter) probe_lang(adapter, &out->langs[out->count++]);
+    }
+
+    const hr_toolchain_t* cc = hr_toolchain_find(out, HR_LANG_C);
+    if (!cc || !cc->available) cc = hr_toolchain_find(out, HR_LANG_CPP);
+    out->linkers = 1u << HR_LINKER_SYSTEM;
+    if (cc && cc->available) {
+        for (int l = HR_LINKER_SYSTEM + 1; l < HR_LINKER_COUNT; l++)
+            if (try_linker(cc->compiler, build_dir, &linkers[l]))
+                out->linkers |= 1u << l;
+    }
+
+    store_cache(path, key, out);
+    out->probe_ns = hr_platform_time_ns() - start;
+    return 1;
+}
+
+static int find_linker(const char* name) {
+    for (int l = 0; l < HR_LINKER_COUNT; l++)
+        if (strcmp(linkers[l].name, name) == 0) return l;
+    return -1;
+}
+
+int hr_toolchain_apply(hr_toolchain_probe_t* probe, const char* linker) {
+    int chosen = HR_LINKER_SYSTEM;
+    int honored = 1;
+    if (!linker || !*linker || strcmp(linker, "auto") == 0) {
+        for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++) {
+            if (probe->linkers & (1u << preference[i])) { chosen = preference[i]; break; }
+        }
+    } else {
+        int wanted = find_linker(linker);
+        if (wanted >= 0 && (probe->linkers & (1u << wanted))) chosen = wanted;
+        else honored = 0;
+    }
+
+    for (int lang = HR_LANG_C; lang <= HR_LANG_GO && lang < HR_TOOLCHAIN_MAX_LANGS; lang++) {
+        hr_adapter_t* adapter = hr_adapter_get((hr_lang_t)lang);
+        if (adapter) probe->adapters[lang] = *adapter;
+    }
+    for (int i = 0; i < probe->count; i++) {
+        hr_toolchain_t* tc = &probe->langs[i];
+        if ((int)tc->lang <= HR_LANG_AUTO || (int)tc->lang >= HR_TOOLCHAIN_MAX_LANGS) continue;
+        hr_adapter_t* adapter = &probe->adapters[tc->lang];
+        if (!adapter->name) continue;
+        if (tc->available) {
+            for (int c = 0; adapter->compilers && adapter->compilers[c]; c++)
+                if (strcmp(adapter->compilers[c], tc->compiler) == 0)
+                    adapter->compiler = adapter->compilers[c];
+        }
+        adapter->linker_flag = adapter->system_linker ? linkers[chosen].flag : NULL;
+        strncpy(tc->linker, adapter->system_linker ? linkers[chosen].name : "builtin",
+                sizeof(tc->linker)-1);
+    }
+    return honored;
+}
+
+/* The context's own copy of an adapter, configured by hr_toolchain_apply. */
+hr_adapter_t* hr_toolchain_adapter(hr_toolchain_probe_t* probe, const hr_adapter_t* adapter) {
+    if (!adapter || (int)adapter->lang <= HR_LANG_AUTO ||
+        (int)adapter->lang >= HR_TOOLCHAIN_MAX_LANGS) return NULL;
+    hr_adapter_t* own = &probe->adapters[adapter->lang];
+    return own->name ? own : NULL;
+}
+
+const hr_toolchain_t* hr_toolchain_find(const hr_toolchain_probe_t* probe, hr_lang_t lang) {
+    for (int i = 0; i < probe->count; i++)
+        if (probe->langs[i].lang == lang) return &probe->langs[i];
+    return NULL;
+}
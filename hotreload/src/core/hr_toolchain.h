@@ -0,0 +1,31 @@
+#ifndef HR_TOOLCHAIN_H
+#define HR_TOOLCHAIN_H
+
+#include "../../include/hotreload.h"
+#include "../adapters/hr_adapter.h"
+
+#define HR_TOOLCHAIN_MAX_LANGS 8
+
+typedef enum {
+    HR_LINKER_SYSTEM = 0,
+    HR_LINKER_GOLD,
+    HR_LINKER_LLD,
+    HR_LINKER_MOLD,
+    HR_LINKER_COUNT
+} hr_linker_t;
+
+typedef struct {
+    hr_toolchain_t langs[HR_TOOLCHAIN_MAX_LANGS];
+    int            count;
+    hr_adapter_t   adapters[HR_TOOLCHAIN_MAX_LANGS];
+    unsigned       linkers;
+    int            from_cache;
+    uint64_t       probe_ns;
+} hr_toolchain_probe_t;
+
+int  hr_toolchain_probe(const char* build_dir, hr_toolchain_probe_t* out);
+int  hr_toolchain_apply(hr_toolchain_probe_t* probe, const char* linker);
+const hr_toolchain_t* hr_toolchain_find(const hr_toolchain_probe_t* probe, hr_lang_t lang);
+hr_adapter_t* hr_toolchain_adapter(hr_toolchain_probe_t* probe, const hr_adapter_t* adapter);
+
+#endif
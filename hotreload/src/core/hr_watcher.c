@@ -1,31 +1,184 @@
 #include "hr_watcher.h"
+#include "hr_symbols.h"
 #include "../platform/hr_platform.h"
 #include <stdlib.h>
 #include <string.h>
 
+#define HR_MAX_PATTERNS 32
+
+typedef struct {
+    char*    path;
+    uint64_t hash;
+    uint64_t last_ns;
+} hr_watch_event_t;
+
 struct hr_watcher {
     hr_watcher_handle_t* platform_handle;
     hr_watcher_cb        cb;
     void*                userdata;
+    hr_watch_event_t*    events;
+    int                  capacity;
+    int                  count;
+    uint64_t             debounce_ns;
+    uint64_t             interval_ns;
+    uint64_t             last_check_ns;
+    uint64_t             overflow_ns;
+    int                  overflowed;
+    hr_watcher_stats_t   stats;
+    char*                filter;
+    const char*          patterns[HR_MAX_PATTERNS];
+    int                  pattern_count;
 };
 
-hr_watcher_t* hr_watcher_create(const char* dir, hr_watcher_cb cb, void* userdata) {
+static int glob_match(const char* pat, const char* str) {
+    const char* star = NULL;
+    const char* resume = NULL;
+    while (*str) {
+        if (*pat == '?' || *pat == *str) { pat++; str++; }
+        else if (*pat == '*')            { star = pat++; resume = str; }
+        else if (star)                   { pat = star + 1; str = ++resume; }
+        else return 0;
+    }
+    while (*pat == '*') pat++;
+    return *pat == 0;
+}
+
+static int passes_filter(const hr_watcher_t* w, const char* path) {
+    if (w->pattern_count == 0) return 1;
+    const char* base = strrchr(path, '/');
+#ifdef _WIN32
+    const char* bs = strrchr(path, '\\');
+    if (bs && (!base || bs > base)) base = bs;
+#endif
+    base = base ? base + 1 : path;
+    for (int i = 0; i < w->pattern_count; i++) {
+        if (glob_match(w->patterns[i], base)) return 1;
+    }
+    return 0;
+}
+
+static void parse_filter(hr_watcher_t* w, const char* filter) {
+    if (!filter || !*filter) return;
+    w->filter = strdup(filter);
+    if (!w->filter) return;
+    for (char* p = w->filter; *p && w->pattern_count < HR_MAX_PATTERNS;) {
+        while (*p == ';' || *p == ',' || *p == ' ') *p++ = 0;
+        if (!*p) break;
+        w->patterns[w->pattern_count++] = p;
+        while (*p && *p != ';' && *p != ',' && *p != ' ') p++;
+    }
+}
+
+static void on_platform_event(const char* path, void* userdata) {
+    hr_watcher_t* w   = (hr_watcher_t*)userdata;
+    uint64_t      now = hr_platform_time_ns();
+    w->stats.received++;
+
+    if (!path) {
+        w->overflowed  = 1;
+        w->overflow_ns = now;
+        w->stats.dropped++;
+        return;
+    }
+
+    if (!passes_filter(w, path)) {
+        w->stats.filtered++;
+        return;
+    }
+
+    uint64_t hash = hr_symbols_hash(path);
+    for (int i = 0; i < w->count; i++) {
+        if (w->events[i].hash == hash && strcmp(w->events[i].path, path) == 0) {
+            w->events[i].last_ns = now;
+            w->stats.coalesced++;
+            return;
+        }
+    }
+
+    char* copy = w->count < w->capacity ? strdup(path) : NULL;
+    if (!copy) {
+        w->overflowed  = 1;
+        w->overflow_ns = now;
+        w->stats.dropped++;
+        return;
+    }
+    hr_watch_event_t* ev = &w->events[w->count++];
+    ev->path    = copy;
+    ev->hash    = hash;
+    ev->last_ns = now;
+}
+
+hr_watcher_t* hr_watcher_create(const char* dir, const hr_watcher_options_t* opts,
+                                hr_watcher_cb cb, void* userdata) {
     hr_watcher_t* w = calloc(1, sizeof(hr_watcher_t));
     if (!w) return NULL;
-    w->cb       = cb;
-    w->userdata = userdata;
-    w->platform_handle = hr_platform_watch_start(dir, cb, userdata);
-    if (!w->platform_handle) { free(w); return NULL; }
+    w->cb          = cb;
+    w->userdata    = userdata;
+    w->capacity    = opts->queue_size > 0 ? opts->queue_size : 1;
+    w->debounce_ns = opts->debounce_ms > 0 ? (uint64_t)opts->debounce_ms * 1000000ULL : 0;
+    w->interval_ns = opts->poll_interval_ms > 0 ? (uint64_t)opts->poll_interval_ms * 1000000ULL : 0;
+    w->events      = calloc((size_t)w->capacity, sizeof(hr_watch_event_t));
+    if (!w->events) { free(w); return NULL; }
+    parse_filter(w, opts->filter);
+
+    hr_watch_options_t popts;
+    popts.recursive   = opts->recursive;
+    popts.exclude_dir = opts->exclude_dir;
+    w->platform_handle = hr_platform_watch_start(dir, &popts, on_platform_event, w);
+    if (!w->platform_handle) { free(w->filter); free(w->events); free(w); return NULL; }
     return w;
 }
 
 void hr_watcher_destroy(hr_watcher_t* w) {
     if (!w) return;
     hr_platform_watch_stop(w->platform_handle);
+    for (int i = 0; i < w->count; i++)
+        free(w->events[i].path);
+    free(w->events);
+    free(w->filter);
     free(w);
 }
 
 void hr_watcher_poll(hr_watcher_t* w) {
     if (!w) return;
-    hr_platform_watch_poll(w->platform_handle);
+    uint64_t now = hr_platform_time_ns();
+    if (now - w->last_check_ns >= w->interval_ns) {
+        w->last_check_ns = now;
+        hr_platform_watch_poll(w->platform_handle);
+        now = hr_platform_time_ns();
+    }
+    if (w->count == 0 && !w->overflowed) return;
+    if (w->overflowed && now - w->overflow_ns >= w->debounce_ns) {
+        w->overflowed = 0;
+        for (int i = 0; i < w->count; i++)
+            free(w->events[i].path);
+        w->count = 0;
+        w->stats.delivered++;
+        w->cb(NULL, w->userdata);
+        return;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < w->count; i++) {
+        hr_watch_event_t ev = w->events[i];
+        if (!w->overflowed && now - ev.last_ns >= w->debounce_ns) {
+            w->stats.delivered++;
+            w->cb(ev.path, w->userdata);
+            free(ev.path);
+        } else {
+            w->events[kept++] = ev;
+        }
+    }
+    w->count = kept;
+}
+
+void hr_watcher_stats(const hr_watcher_t* w, hr_watcher_stats_t* out) {
+    *out = w->stats;
+    out->pending = w->count;
+    hr_watch_info_t info;
+    hr_platform_watch_info(w->platform_handle, &info);
+    out->directories  = info.directories;
+    out->memory_bytes = info.memory_bytes + sizeof(*w) +
+                        sizeof(hr_watch_event_t) * (size_t)w->capacity;
+    out->startup_ns   = info.startup_ns;
 }
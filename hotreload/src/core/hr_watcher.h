@@ -1,12 +1,38 @@
 #ifndef HR_WATCHER_H
 #define HR_WATCHER_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 typedef void (*hr_watcher_cb)(const char* path, void* userdata);
 
 typedef struct hr_watcher hr_watcher_t;
 
-hr_watcher_t* hr_watcher_create(const char* dir, hr_watcher_cb cb, void* userdata);
+typedef struct {
+    int         queue_size;
+    int         debounce_ms;
+    int         poll_interval_ms;
+    int         recursive;
+    const char* filter;
+    const char* exclude_dir;
+} hr_watcher_options_t;
+
+typedef struct {
+    uint64_t received;
+    uint64_t delivered;
+    uint64_t coalesced;
+    uint64_t dropped;
+    uint64_t filtered;
+    int      pending;
+    int      directories;
+    size_t   memory_bytes;
+    uint64_t startup_ns;
+} hr_watcher_stats_t;
+
+hr_watcher_t* hr_watcher_create(const char* dir, const hr_watcher_options_t* opts,
+                                hr_watcher_cb cb, void* userdata);
 void          hr_watcher_destroy(hr_watcher_t* w);
 void          hr_watcher_poll(hr_watcher_t* w);
+void          hr_watcher_stats(const hr_watcher_t* w, hr_watcher_stats_t* out);
 
 #endif
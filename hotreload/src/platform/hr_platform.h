@@ -4,31 +4,101 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define HR_PLATFORM_CANCELLED (-2)
+
 typedef void (*hr_file_changed_cb)(const char* path, void* userdata);
 
 typedef struct hr_watcher_handle hr_watcher_handle_t;
+typedef struct hr_thread hr_thread_t;
+typedef struct hr_mutex  hr_mutex_t;
+typedef struct hr_cond   hr_cond_t;
+typedef struct hr_file_lock hr_file_lock_t;
+typedef void (*hr_thread_fn)(void* arg);
+typedef void (*hr_dir_entry_cb)(const char* path, int64_t size, int64_t mtime, void* userdata);
+
+typedef struct {
+    int         recursive;
+    const char* exclude_dir;
+} hr_watch_options_t;
+
+typedef struct {
+    int      status;
+    char*    out;
+    size_t   out_len;
+    char*    err;
+    size_t   err_len;
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+} hr_process_result_t;
 
-hr_watcher_handle_t* hr_platform_watch_start(const char* dir, hr_file_changed_cb cb, void* userdata);
+typedef struct {
+    int      directories;
+    size_t   memory_bytes;
+    uint64_t startup_ns;
+} hr_watch_info_t;
+
+hr_watcher_handle_t* hr_platform_watch_start(const char* dir, const hr_watch_options_t* opts,
+                                             hr_file_changed_cb cb, void* userdata);
 void                 hr_platform_watch_stop(hr_watcher_handle_t* handle);
 void                 hr_platform_watch_poll(hr_watcher_handle_t* handle);
+void                 hr_platform_watch_info(const hr_watcher_handle_t* handle, hr_watch_info_t* out);
 
 void*  hr_platform_alloc_exec(size_t size);
+void*  hr_platform_alloc_exec_near(const void* near, size_t size, uint64_t range);
 void   hr_platform_free_exec(void* addr, size_t size);
 int    hr_platform_make_writable(void* addr, size_t size);
 int    hr_platform_make_executable(void* addr, size_t size);
+int    hr_platform_protect_data(void* addr, size_t size, int writable);
+size_t hr_platform_page_size(void);
 
 void*  hr_platform_lib_open(const char* path);
 void*  hr_platform_lib_sym(void* handle, const char* name);
 int    hr_platform_lib_close(void* handle);
+int    hr_platform_lib_base(void* handle, uintptr_t* base);
 const char* hr_platform_lib_error(void);
 
 int    hr_platform_file_exists(const char* path);
 int64_t hr_platform_file_mtime(const char* path);
 int    hr_platform_mkdir(const char* path);
-int    hr_platform_run_command(const char* cmd, char* output, size_t output_size);
+int64_t hr_platform_file_size(const char* path);
+int    hr_platform_file_touch(const char* path);
+int    hr_platform_copy_file(const char* from, const char* to);
+int    hr_platform_rename(const char* from, const char* to);
+int    hr_platform_list_dir(const char* dir, hr_dir_entry_cb cb, void* userdata);
+int    hr_platform_find_program(const char* name, char* out, size_t out_size);
+hr_file_lock_t* hr_platform_file_trylock(const char* path);
+void   hr_platform_file_unlock(hr_file_lock_t* lock);
+int    hr_platform_process_id(void);
+const void* hr_platform_map_file(const char* path, size_t* size);
+void   hr_platform_unmap_file(const void* addr, size_t size);
+int    hr_platform_realpath(const char* path, char* out, size_t out_size);
+int    hr_platform_spawn(const char* const* argv, hr_process_result_t* result);
+void   hr_platform_process_result_free(hr_process_result_t* result);
+void   hr_platform_set_cancel_flag(volatile int* flag);
+
+hr_thread_t* hr_platform_thread_start(hr_thread_fn fn, void* arg);
+void         hr_platform_thread_join(hr_thread_t* thread);
+hr_mutex_t*  hr_platform_mutex_create(void);
+void         hr_platform_mutex_destroy(hr_mutex_t* mutex);
+void         hr_platform_mutex_lock(hr_mutex_t* mutex);
+void         hr_platform_mutex_unlock(hr_mutex_t* mutex);
+hr_cond_t*   hr_platform_cond_create(void);
+void         hr_platform_cond_destroy(hr_cond_t* cond);
+void         hr_platform_cond_wait(hr_cond_t* cond, hr_mutex_t* mutex);
+void         hr_platform_cond_broadcast(hr_cond_t* cond);
+uint64_t     hr_platform_time_ns(void);
+int          hr_platform_cpu_count(void);
 
-void   hr_platform_thread_pause_others(void);
-void   hr_platform_thread_resume_others(void);
+/* Stops every other thread of the process; returns how many, or -1 if some
+   could not be stopped (nothing is left paused then). Must be followed by
+   hr_platform_thread_resume_others, with no allocation in between.
+   hr_platform_thread_step lets the paused threads whose instruction pointer
+   is busy run briefly, pauses them again and returns how many still are. */
+typedef int (*hr_ip_filter_fn)(uintptr_t ip, void* userdata);
+int       hr_platform_thread_pause_others(void);
+uintptr_t hr_platform_thread_paused_ip(int index);
+int       hr_platform_thread_step(hr_ip_filter_fn busy, void* userdata);
+void      hr_platform_thread_resume_others(void);
 void   hr_platform_sleep_ms(int ms);
 
 const char* hr_platform_lib_ext(void);
@@ -1,5 +1,6 @@
 #ifdef __linux__
 
+#define _GNU_SOURCE
 #include "hr_platform.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,58 +12,215 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include <dlfcn.h>
+#include <link.h>
 #include <dirent.h>
 #include <signal.h>
 #include <errno.h>
 #include <time.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <ucontext.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #define INOTIFY_BUF_SIZE (4096 * (sizeof(struct inotify_event) + 16))
+#define HR_DIR_MASK      (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR | IN_EXCL_UNLINK)
+
+typedef struct {
+    int   wd;
+    char* path;
+} hr_watch_dir_t;
 
 struct hr_watcher_handle {
     int fd;
-    int wd;
     hr_file_changed_cb cb;
     void* userdata;
     char watch_dir[4096];
+    char exclude_dir[4096];
+    int  recursive;
+    hr_watch_dir_t* dirs;
+    int  dir_capacity;
+    int  dir_count;
+    size_t path_bytes;
+    uint64_t startup_ns;
+    int  limit_warned;
 };
 
-hr_watcher_handle_t* hr_platform_watch_start(const char* dir, hr_file_changed_cb cb, void* userdata) {
+static hr_watch_dir_t* find_dir_slot(hr_watcher_handle_t* h, int wd) {
+    uint32_t mask = (uint32_t)h->dir_capacity - 1;
+    uint32_t i    = ((uint32_t)wd * 2654435761u) & mask;
+    while (h->dirs[i].path && h->dirs[i].wd != wd)
+        i = (i + 1) & mask;
+    return &h->dirs[i];
+}
+
+static int grow_dirs(hr_watcher_handle_t* h) {
+    int capacity = h->dir_capacity ? h->dir_capacity * 2 : 64;
+    hr_watch_dir_t* old = h->dirs;
+    int old_capacity    = h->dir_capacity;
+    h->dirs = calloc((size_t)capacity, sizeof(hr_watch_dir_t));
+    if (!h->dirs) { h->dirs = old; return 0; }
+    h->dir_capacity = capacity;
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].path) *find_dir_slot(h, old[i].wd) = old[i];
+    }
+    free(old);
+    return 1;
+}
+
+static void forget_dir(hr_watcher_handle_t* h, int wd) {
+    hr_watch_dir_t* slot = find_dir_slot(h, wd);
+    if (!slot->path) return;
+    h->path_bytes -= strlen(slot->path) + 1;
+    free(slot->path);
+    slot->path = NULL;
+    h->dir_count--;
+
+    uint32_t mask = (uint32_t)h->dir_capacity - 1;
+    uint32_t i    = (uint32_t)(slot - h->dirs);
+    for (uint32_t j = (i + 1) & mask; h->dirs[j].path; j = (j + 1) & mask) {
+        hr_watch_dir_t moved = h->dirs[j];
+        h->dirs[j].path = NULL;
+        *find_dir_slot(h, moved.wd) = moved;
+    }
+}
+
+static int is_excluded(const hr_watcher_handle_t* h, const char* path) {
+    if (!h->exclude_dir[0]) return 0;
+    size_t n = strlen(h->exclude_dir);
+    return strncmp(path, h->exclude_dir, n) == 0 && (path[n] == 0 || path[n] == '/');
+}
+
+static void add_tree(hr_watcher_handle_t* h, const char* dir, int report_files) {
+    if (is_excluded(h, dir)) return;
+    if ((h->dir_count + 1) * 2 > h->dir_capacity && !grow_dirs(h)) return;
+
+    int wd = inotify_add_watch(h->fd, dir, HR_DIR_MASK);
+    if (wd < 0) {
+        if (errno == ENOSPC && !h->limit_warned) {
+            fprintf(stderr, "[hr:watch] inotify watch limit reached at %s "
+                            "(raise fs.inotify.max_user_watches)\n", dir);
+            h->limit_warned = 1;
+        }
+        return;
+    }
+    hr_watch_dir_t* slot = find_dir_slot(h, wd);
+    if (slot->path && strcmp(slot->path, dir) != 0) {
+        h->path_bytes -= strlen(slot->path) + 1;
+        free(slot->path);
+        slot->path = NULL;
+        h->dir_count--;
+    }
+    if (!slot->path) {
+        slot->wd   = wd;
+        slot->path = strdup(dir);
+        if (!slot->path) { inotify_rm_watch(h->fd, wd); return; }
+        h->dir_count++;
+        h->path_bytes += strlen(dir) + 1;
+    }
+    if (!h->recursive && !report_files) return;
+
+    DIR* d = opendir(dir);
+    if (!d) return;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char path[4096];
+        if (snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name) >= (int)sizeof(path)) continue;
+        unsigned char type = ent->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (lstat(path, &st) != 0) continue;
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+        }
+        if (type == DT_DIR && h->recursive)
+            add_tree(h, path, report_files);
+        else if (type == DT_REG && report_files)
+            h->cb(path, h->userdata);
+    }
+    closedir(d);
+}
+
+hr_watcher_handle_t* hr_platform_watch_start(const char* dir, const hr_watch_options_t* opts,
+                                             hr_file_changed_cb cb, void* userdata) {
     hr_watcher_handle_t* h = calloc(1, sizeof(hr_watcher_handle_t));
     if (!h) return NULL;
-    h->fd = inotify_init1(IN_NONBLOCK);
+    uint64_t t0 = hr_platform_time_ns();
+    h->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
     if (h->fd < 0) { free(h); return NULL; }
-    h->wd = inotify_add_watch(h->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
-    if (h->wd < 0) { close(h->fd); free(h); return NULL; }
     h->cb = cb;
-    h->userdata = userdata;
-    strncpy(h->watch_dir, dir, sizeof(h->watch_dir) - 1);
+    h->userdata  = userdata;
+    h->recursive = opts && opts->recursive;
+    if (!hr_platform_realpath(dir, h->watch_dir, sizeof(h->watch_dir)))
+        strncpy(h->watch_dir, dir, sizeof(h->watch_dir) - 1);
+    if (opts && opts->exclude_dir &&
+        !hr_platform_realpath(opts->exclude_dir, h->exclude_dir, sizeof(h->exclude_dir)))
+        h->exclude_dir[0] = 0;
+    if (strcmp(h->exclude_dir, h->watch_dir) == 0)
+        h->exclude_dir[0] = 0;
+
+    add_tree(h, h->watch_dir, 0);
+    if (h->dir_count == 0) { close(h->fd); free(h->dirs); free(h); return NULL; }
+    h->startup_ns = hr_platform_time_ns() - t0;
     return h;
 }
 
 void hr_platform_watch_stop(hr_watcher_handle_t* handle) {
     if (!handle) return;
-    inotify_rm_watch(handle->fd, handle->wd);
     close(handle->fd);
+    for (int i = 0; i < handle->dir_capacity; i++)
+        free(handle->dirs[i].path);
+    free(handle->dirs);
     free(handle);
 }
 
 void hr_platform_watch_poll(hr_watcher_handle_t* handle) {
     if (!handle) return;
     char buf[INOTIFY_BUF_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
-    ssize_t len = read(handle->fd, buf, sizeof(buf));
-    if (len <= 0) return;
-    char* ptr = buf;
-    while (ptr < buf + len) {
-        struct inotify_event* ev = (struct inotify_event*)ptr;
-        if ((ev->mask & IN_CLOSE_WRITE || ev->mask & IN_MOVED_TO) && ev->len > 0) {
+    for (;;) {
+        ssize_t len = read(handle->fd, buf, sizeof(buf));
+        if (len <= 0) return;
+        char* ptr = buf;
+        while (ptr < buf + len) {
+            struct inotify_event* ev = (struct inotify_event*)ptr;
+            ptr += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                handle->cb(NULL, handle->userdata);
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {
+                forget_dir(handle, ev->wd);
+                continue;
+            }
+            if (ev->len == 0) continue;
+            const hr_watch_dir_t* dir = find_dir_slot(handle, ev->wd);
+            if (!dir->path) continue;
+
             char full_path[8192];
-            snprintf(full_path, sizeof(full_path), "%s/%s", handle->watch_dir, ev->name);
-            handle->cb(full_path, handle->userdata);
+            snprintf(full_path, sizeof(full_path), "%s/%s", dir->path, ev->name);
+            if (ev->mask & IN_ISDIR) {
+                if (handle->recursive && ev->name[0] != '.' &&
+                    (ev->mask & (IN_CREATE | IN_MOVED_TO)) && strlen(full_path) < 4096)
+                    add_tree(handle, full_path, 1);
+            } else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                handle->cb(full_path, handle->userdata);
+            }
         }
-        ptr += sizeof(struct inotify_event) + ev->len;
+        if ((size_t)len < sizeof(buf) / 2) return;
     }
 }
 
+void hr_platform_watch_info(const hr_watcher_handle_t* handle, hr_watch_info_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!handle) return;
+    out->directories  = handle->dir_count;
+    out->memory_bytes = sizeof(*handle) + handle->path_bytes +
+                        sizeof(hr_watch_dir_t) * (size_t)handle->dir_capacity;
+    out->startup_ns   = handle->startup_ns;
+}
+
 void* hr_platform_alloc_exec(size_t size) {
     void* p = mmap(NULL, size, PROT_READ | PROT_WRITE | PROT_EXEC,
                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -73,12 +231,24 @@ void hr_platform_free_exec(void* addr, size_t size) {
     munmap(addr, size);
 }
 
+static int protect_pages(void* addr, size_t size, int prot) {
+    uintptr_t page  = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(page - 1);
+    uintptr_t end   = ((uintptr_t)addr + size + page - 1) & ~(page - 1);
+    return mprotect((void*)start, end - start, prot) == 0;
+}
+
+/* The page stays executable while it is written: other functions on it may be running. */
 int hr_platform_make_writable(void* addr, size_t size) {
-    return mprotect(addr, size, PROT_READ | PROT_WRITE) == 0;
+    return protect_pages(addr, size, PROT_READ | PROT_WRITE | PROT_EXEC);
 }
 
 int hr_platform_make_executable(void* addr, size_t size) {
-    return mprotect(addr, size, PROT_READ | PROT_EXEC) == 0;
+    return protect_pages(addr, size, PROT_READ | PROT_EXEC);
+}
+
+int hr_platform_protect_data(void* addr, size_t size, int writable) {
+    return protect_pages(addr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ);
 }
 
 void* hr_platform_lib_open(const char* path) {
@@ -93,6 +263,13 @@ int hr_platform_lib_close(void* handle) {
     return dlclose(handle) == 0;
 }
 
+int hr_platform_lib_base(void* handle, uintptr_t* base) {
+    struct link_map* lm = NULL;
+    if (dlinfo(handle, RTLD_DI_LINKMAP, &lm) != 0 || !lm) return 0;
+    *base = (uintptr_t)lm->l_addr;
+    return 1;
+}
+
 const char* hr_platform_lib_error(void) {
     return dlerror();
 }
@@ -122,25 +299,237 @@ int hr_platform_mkdir(const char* path) {
     return mkdir(tmp, 0755) == 0 || errno == EEXIST;
 }
 
-int hr_platform_run_command(const char* cmd, char* output, size_t output_size) {
-    FILE* fp = popen(cmd, "r");
-    if (!fp) return -1;
-    size_t total = 0;
-    if (output && output_size > 0) {
-        while (total < output_size - 1) {
-            size_t n = fread(output + total, 1, output_size - 1 - total, fp);
-            if (n == 0) break;
-            total += n;
+#define HR_PAUSE_SIGNAL     (SIGRTMAX - 2)
+#define HR_PAUSE_MAX        1024
+#define HR_PAUSE_TIMEOUT_NS (100ULL * 1000000ULL)
+#define HR_PAUSE_STEP_NS    20000L
+
+/* Stop-the-world state. Each thread is sent HR_PAUSE_SIGNAL tagged with the
+   current epoch (and, when it is paused again after a step, with its slot).
+   Its handler records where the thread was interrupted and parks on its
+   slot's futex word until released; a handler that runs late sees a stale
+   epoch and returns at once. Resuming waits until no handler of the ending
+   pause is still running, so none can claim a slot in the next one. Nothing
+   between pause and resume may allocate or take a lock: a paused thread
+   could be holding it. */
+static struct {
+    pthread_mutex_t lock;
+    int             installed;
+    int             epoch;
+    int             active;
+    int             claimed;
+    int             arrived;
+    int             inside;
+    int             signaled;
+    pid_t           signaled_tids[HR_PAUSE_MAX];
+    pid_t           tids[HR_PAUSE_MAX];
+    uintptr_t       ips[HR_PAUSE_MAX];
+    int             hold[HR_PAUSE_MAX];
+} g_pause = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uintptr_t context_ip(void* context) {
+    ucontext_t* uc = (ucontext_t*)context;
+#if defined(__x86_64__)
+    return (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+    return (uintptr_t)uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+    return (uintptr_t)uc->uc_mcontext.pc;
+#else
+    (void)uc;
+    return 0;
+#endif
+}
+
+static void pause_handler(int sig, siginfo_t* info, void* context) {
+    (void)sig;
+    int saved_errno = errno;
+    uint64_t tag = (uint64_t)(uintptr_t)info->si_value.sival_ptr;
+    int epoch = (int)(tag >> 32);
+    int slot  = (int)(tag & 0xFFFFFFFFu) - 1;
+    /* active is stored after epoch, so seeing it set means the epoch read
+       next is the current one. */
+    __atomic_fetch_add(&g_pause.inside, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&g_pause.active, __ATOMIC_SEQ_CST) ||
+        epoch != __atomic_load_n(&g_pause.epoch, __ATOMIC_SEQ_CST)) {
+        __atomic_fetch_sub(&g_pause.inside, 1, __ATOMIC_SEQ_CST);
+        errno = saved_errno;
+        return;
+    }
+    if (slot < 0) slot = __atomic_fetch_add(&g_pause.claimed, 1, __ATOMIC_RELAXED);
+    if (slot >= HR_PAUSE_MAX) {
+        __atomic_fetch_add(&g_pause.arrived, 1, __ATOMIC_SEQ_CST);
+        __atomic_fetch_sub(&g_pause.inside, 1, __ATOMIC_SEQ_CST);
+        errno = saved_errno;
+        return;
+    }
+    g_pause.tids[slot] = (pid_t)syscall(SYS_gettid);
+    g_pause.ips[slot]  = context_ip(context);
+    __atomic_store_n(&g_pause.hold[slot], 1, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&g_pause.arrived, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&g_pause.hold[slot], __ATOMIC_SEQ_CST) &&
+           __atomic_load_n(&g_pause.active, __ATOMIC_SEQ_CST))
+        syscall(SYS_futex, &g_pause.hold[slot], FUTEX_WAIT_PRIVATE, 1, NULL, NULL, 0);
+    __atomic_fetch_sub(&g_pause.inside, 1, __ATOMIC_SEQ_CST);
+    errno = saved_errno;
+}
+
+static int install_pause_handler(void) {
+    if (g_pause.installed) return 1;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = pause_handler;
+    sa.sa_flags     = SA_SIGINFO | SA_RESTART;
+    sigfillset(&sa.sa_mask);
+    if (sigaction(HR_PAUSE_SIGNAL, &sa, NULL) != 0) return 0;
+    g_pause.installed = 1;
+    return 1;
+}
+
+static int send_pause(pid_t pid, pid_t tid, int slot) {
+    siginfo_t si;
+    memset(&si, 0, sizeof(si));
+    si.si_signo = HR_PAUSE_SIGNAL;
+    si.si_code  = SI_QUEUE;
+    si.si_pid   = pid;
+    si.si_uid   = getuid();
+    si.si_value.sival_ptr = (void*)(uintptr_t)(((uint64_t)(uint32_t)g_pause.epoch << 32) |
+                                               (uint32_t)(slot + 1));
+    return (int)syscall(SYS_rt_tgsigqueueinfo, pid, tid, HR_PAUSE_SIGNAL, &si);
+}
+
+static int already_signaled(pid_t tid) {
+    for (int i = 0; i < g_pause.signaled; i++)
+        if (g_pause.signaled_tids[i] == tid) return 1;
+    return 0;
+}
+
+/* Signals every thread of the process not signaled yet. Reads the task list
+   with raw getdents64 so no allocation happens while threads are parked.
+   Returns the number of new threads signaled, or -1 on failure. */
+static int signal_new_threads(pid_t self) {
+    int fd = open("/proc/self/task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    pid_t pid = getpid();
+    int sent = 0;
+    char buf[4096];
+    long n;
+    while ((n = syscall(SYS_getdents64, fd, buf, sizeof(buf))) > 0) {
+        for (long off = 0; off < n;) {
+            struct dirent64* d = (struct dirent64*)(buf + off);
+            off += d->d_reclen;
+            if (d->d_name[0] < '0' || d->d_name[0] > '9') continue;
+            pid_t tid = (pid_t)strtol(d->d_name, NULL, 10);
+            if (tid == self || already_signaled(tid)) continue;
+            if (g_pause.signaled >= HR_PAUSE_MAX) { close(fd); return -1; }
+            if (send_pause(pid, tid, -1) != 0) {
+                if (errno == ESRCH) continue;
+                close(fd);
+                return -1;
+            }
+            g_pause.signaled_tids[g_pause.signaled++] = tid;
+            sent++;
         }
-        output[total] = 0;
     }
-    return pclose(fp);
+    close(fd);
+    return n < 0 ? -1 : sent;
+}
+
+static int wait_arrived(int target, uint64_t deadline) {
+    while (__atomic_load_n(&g_pause.arrived, __ATOMIC_SEQ_CST) < target) {
+        if (hr_platform_time_ns() > deadline) return 0;
+        sched_yield();
+    }
+    return 1;
+}
+
+static void release_slot(int slot) {
+    __atomic_store_n(&g_pause.hold[slot], 0, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &g_pause.hold[slot], FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static void release_threads(void) {
+    __atomic_store_n(&g_pause.active, 0, __ATOMIC_SEQ_CST);
+    int claimed = __atomic_load_n(&g_pause.claimed, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < claimed && i < HR_PAUSE_MAX; i++)
+        release_slot(i);
+    /* A handler that passed its checks just before active was cleared may
+       claim a slot past the count read above and park there. */
+    while (__atomic_load_n(&g_pause.inside, __ATOMIC_SEQ_CST) > 0) {
+        claimed = __atomic_load_n(&g_pause.claimed, __ATOMIC_SEQ_CST);
+        for (int i = 0; i < claimed && i < HR_PAUSE_MAX; i++)
+            if (__atomic_load_n(&g_pause.hold[i], __ATOMIC_SEQ_CST)) release_slot(i);
+        sched_yield();
+    }
+}
+
+static int paused_count(void) {
+    return g_pause.claimed < HR_PAUSE_MAX ? g_pause.claimed : HR_PAUSE_MAX;
+}
+
+int hr_platform_thread_pause_others(void) {
+    pthread_mutex_lock(&g_pause.lock);
+    if (!install_pause_handler()) {
+        pthread_mutex_unlock(&g_pause.lock);
+        return -1;
+    }
+    g_pause.claimed  = 0;
+    g_pause.arrived  = 0;
+    g_pause.signaled = 0;
+    __atomic_store_n(&g_pause.epoch, g_pause.epoch + 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&g_pause.active, 1, __ATOMIC_SEQ_CST);
+
+    pid_t self = (pid_t)syscall(SYS_gettid);
+    uint64_t deadline = hr_platform_time_ns() + HR_PAUSE_TIMEOUT_NS;
+    int sent;
+    /* A thread that was running during one pass may have started another;
+       repeat until a pass finds nobody new. */
+    while ((sent = signal_new_threads(self)) > 0) {
+        if (!wait_arrived(g_pause.signaled, deadline)) { sent = -1; break; }
+    }
+    if (sent < 0) {
+        release_threads();
+        pthread_mutex_unlock(&g_pause.lock);
+        return -1;
+    }
+    return paused_count();
 }
 
-void hr_platform_thread_pause_others(void) {
+uintptr_t hr_platform_thread_paused_ip(int index) {
+    return index >= 0 && index < HR_PAUSE_MAX ? g_pause.ips[index] : 0;
+}
+
+int hr_platform_thread_step(hr_ip_filter_fn busy, void* userdata) {
+    int count = paused_count();
+    int stepped = 0;
+    for (int i = 0; i < count; i++) {
+        if (!busy(g_pause.ips[i], userdata)) continue;
+        g_pause.ips[i] = 0;
+        release_slot(i);
+        stepped++;
+    }
+    if (stepped == 0) return 0;
+
+    struct timespec ts = { 0, HR_PAUSE_STEP_NS };
+    nanosleep(&ts, NULL);
+    pid_t pid = getpid();
+    int target = __atomic_load_n(&g_pause.arrived, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < count; i++) {
+        if (g_pause.ips[i] != 0) continue;
+        if (send_pause(pid, g_pause.tids[i], i) == 0) target++;
+        else if (errno != ESRCH) return -1;
+    }
+    if (!wait_arrived(target, hr_platform_time_ns() + HR_PAUSE_TIMEOUT_NS)) return -1;
+
+    int left = 0;
+    for (int i = 0; i < count; i++)
+        if (g_pause.ips[i] != 0 && busy(g_pause.ips[i], userdata)) left++;
+    return left;
 }
 
 void hr_platform_thread_resume_others(void) {
+    release_threads();
+    pthread_mutex_unlock(&g_pause.lock);
 }
 
 void hr_platform_sleep_ms(int ms) {
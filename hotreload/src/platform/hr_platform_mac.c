@@ -25,16 +25,26 @@ struct hr_watcher_handle {
     hr_file_changed_cb cb;
     void* userdata;
     char watch_dir[4096];
+    char exclude_dir[4096];
+    int  recursive;
+    int  dirs;
+    uint64_t startup_ns;
 };
 
 static void scan_dir_fds(hr_watcher_handle_t* h, const char* dir) {
+    if (h->exclude_dir[0] && strcmp(dir, h->exclude_dir) == 0) return;
     DIR* d = opendir(dir);
     if (!d) return;
+    h->dirs++;
     struct dirent* ent;
     while ((ent = readdir(d)) != NULL && h->count < MAX_WATCH_FILES) {
         if (ent->d_name[0] == '.') continue;
         char path[4096];
         snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        if (ent->d_type == DT_DIR) {
+            if (h->recursive) scan_dir_fds(h, path);
+            continue;
+        }
         int fd = open(path, O_RDONLY);
         if (fd < 0) continue;
         struct kevent ke;
@@ -48,15 +58,25 @@ static void scan_dir_fds(hr_watcher_handle_t* h, const char* dir) {
     closedir(d);
 }
 
-hr_watcher_handle_t* hr_platform_watch_start(const char* dir, hr_file_changed_cb cb, void* userdata) {
+hr_watcher_handle_t* hr_platform_watch_start(const char* dir, const hr_watch_options_t* opts,
+                                             hr_file_changed_cb cb, void* userdata) {
     hr_watcher_handle_t* h = calloc(1, sizeof(hr_watcher_handle_t));
     if (!h) return NULL;
+    uint64_t t0 = hr_platform_time_ns();
     h->kq = kqueue();
     if (h->kq < 0) { free(h); return NULL; }
     h->cb = cb;
-    h->userdata = userdata;
-    strncpy(h->watch_dir, dir, sizeof(h->watch_dir) - 1);
-    scan_dir_fds(h, dir);
+    h->userdata  = userdata;
+    h->recursive = opts && opts->recursive;
+    if (!hr_platform_realpath(dir, h->watch_dir, sizeof(h->watch_dir)))
+        strncpy(h->watch_dir, dir, sizeof(h->watch_dir) - 1);
+    if (opts && opts->exclude_dir &&
+        !hr_platform_realpath(opts->exclude_dir, h->exclude_dir, sizeof(h->exclude_dir)))
+        h->exclude_dir[0] = 0;
+    if (strcmp(h->exclude_dir, h->watch_dir) == 0)
+        h->exclude_dir[0] = 0;
+    scan_dir_fds(h, h->watch_dir);
+    h->startup_ns = hr_platform_time_ns() - t0;
     return h;
 }
 
@@ -83,6 +103,14 @@ void hr_platform_watch_poll(hr_watcher_handle_t* handle) {
     }
 }
 
+void hr_platform_watch_info(const hr_watcher_handle_t* handle, hr_watch_info_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!handle) return;
+    out->directories  = handle->dirs;
+    out->memory_bytes = sizeof(*handle);
+    out->startup_ns   = handle->startup_ns;
+}
+
 void* hr_platform_alloc_exec(size_t size) {
     void* p = mmap(NULL, size, PROT_READ | PROT_WRITE | PROT_EXEC,
                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -93,12 +121,24 @@ void hr_platform_free_exec(void* addr, size_t size) {
     munmap(addr, size);
 }
 
+static int protect_pages(void* addr, size_t size, int prot) {
+    uintptr_t page  = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(page - 1);
+    uintptr_t end   = ((uintptr_t)addr + size + page - 1) & ~(page - 1);
+    return mprotect((void*)start, end - start, prot) == 0;
+}
+
+/* The page stays executable while it is written: other functions on it may be running. */
 int hr_platform_make_writable(void* addr, size_t size) {
-    return mprotect(addr, size, PROT_READ | PROT_WRITE) == 0;
+    return protect_pages(addr, size, PROT_READ | PROT_WRITE | PROT_EXEC);
 }
 
 int hr_platform_make_executable(void* addr, size_t size) {
-    return mprotect(addr, size, PROT_READ | PROT_EXEC) == 0;
+    return protect_pages(addr, size, PROT_READ | PROT_EXEC);
+}
+
+int hr_platform_protect_data(void* addr, size_t size, int writable) {
+    return protect_pages(addr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ);
 }
 
 void* hr_platform_lib_open(const char* path) {
@@ -113,6 +153,11 @@ int hr_platform_lib_close(void* handle) {
     return dlclose(handle) == 0;
 }
 
+int hr_platform_lib_base(void* handle, uintptr_t* base) {
+    (void)handle; (void)base;
+    return 0;
+}
+
 const char* hr_platform_lib_error(void) {
     return dlerror();
 }
@@ -142,22 +187,9 @@ int hr_platform_mkdir(const char* path) {
     return mkdir(tmp, 0755) == 0 || errno == EEXIST;
 }
 
-int hr_platform_run_command(const char* cmd, char* output, size_t output_size) {
-    FILE* fp = popen(cmd, "r");
-    if (!fp) return -1;
-    size_t total = 0;
-    if (output && output_size > 0) {
-        while (total < output_size - 1) {
-            size_t n = fread(output + total, 1, output_size - 1 - total, fp);
-            if (n == 0) break;
-            total += n;
-        }
-        output[total] = 0;
-    }
-    return pclose(fp);
-}
-
-void hr_platform_thread_pause_others(void) {}
+int hr_platform_thread_pause_others(void) { return 0; }
+uintptr_t hr_platform_thread_paused_ip(int index) { (void)index; return 0; }
+int hr_platform_thread_step(hr_ip_filter_fn busy, void* userdata) { (void)busy; (void)userdata; return 0; }
 void hr_platform_thread_resume_others(void) {}
 
 void hr_platform_sleep_ms(int ms) {
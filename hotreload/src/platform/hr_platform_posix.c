@@ -0,0 +1,406 @@
+#if defined(__linux__) || defined(__APPLE__)
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "hr_platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <limits.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#define HR_CANCEL_POLL_MS 20
+
+extern char** environ;
+
+struct hr_file_lock {
+    int  fd;
+    char path[4096];
+};
+
+struct hr_thread {
+    pthread_t    id;
+    hr_thread_fn fn;
+    void*        arg;
+};
+
+struct hr_mutex {
+    pthread_mutex_t m;
+};
+
+struct hr_cond {
+    pthread_cond_t c;
+};
+
+static _Thread_local volatile int* t_cancel_flag;
+
+static int make_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) != 0) return -1;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+void hr_platform_set_cancel_flag(volatile int* flag) {
+    t_cancel_flag = flag;
+}
+
+typedef struct {
+    char*  data;
+    size_t len;
+    size_t cap;
+} hr_capture_t;
+
+static int capture_read(int fd, hr_capture_t* cap) {
+    if (cap->cap - cap->len < 4096 + 1) {
+        size_t size = cap->cap ? cap->cap * 2 : 8192;
+        char* data = realloc(cap->data, size);
+        if (!data) return -1;
+        cap->data = data;
+        cap->cap  = size;
+    }
+    ssize_t n = read(fd, cap->data + cap->len, cap->cap - cap->len - 1);
+    if (n > 0) {
+        cap->len += (size_t)n;
+        cap->data[cap->len] = 0;
+    }
+    return (int)n;
+}
+
+static char* capture_finish(hr_capture_t* cap, size_t* len) {
+    *len = cap->len;
+    return cap->data ? cap->data : calloc(1, 1);
+}
+
+int hr_platform_spawn(const char* const* argv, hr_process_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    result->status = -1;
+    int out_fds[2], err_fds[2];
+    if (make_pipe(out_fds) != 0) return -1;
+    if (make_pipe(err_fds) != 0) { close(out_fds[0]); close(out_fds[1]); return -1; }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, out_fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err_fds[1], STDERR_FILENO);
+
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    uint64_t start = hr_platform_time_ns();
+    pid_t pid;
+    int rc = posix_spawnp(&pid, argv[0], &actions, &attr, (char* const*)argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(out_fds[1]);
+    close(err_fds[1]);
+    if (rc != 0) {
+        close(out_fds[0]);
+        close(err_fds[0]);
+        fprintf(stderr, "[hr:platform] cannot run %s: %s\n", argv[0], strerror(rc));
+        return -1;
+    }
+
+    hr_capture_t captures[2] = {{0}, {0}};
+    struct pollfd pfds[2] = {{ out_fds[0], POLLIN, 0 }, { err_fds[0], POLLIN, 0 }};
+    int open_fds  = 2;
+    int cancelled = 0;
+    while (open_fds > 0) {
+        if (!cancelled && t_cancel_flag && *t_cancel_flag) {
+            kill(-pid, SIGKILL);
+            cancelled = 1;
+        }
+        int ready = poll(pfds, 2, HR_CANCEL_POLL_MS);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+        for (int i = 0; i < 2; i++) {
+            if (pfds[i].fd < 0 || !pfds[i].revents) continue;
+            int n = capture_read(pfds[i].fd, &captures[i]);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                close(pfds[i].fd);
+                pfds[i].fd = -1;
+                open_fds--;
+            }
+        }
+    }
+    for (int i = 0; i < 2; i++)
+        if (pfds[i].fd >= 0) close(pfds[i].fd);
+
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    pid_t waited;
+    while ((waited = wait4(pid, &status, 0, &usage)) < 0 && errno == EINTR) {}
+    result->wall_ns = hr_platform_time_ns() - start;
+    result->cpu_ns  = ((uint64_t)usage.ru_utime.tv_sec + (uint64_t)usage.ru_stime.tv_sec) * 1000000000ULL +
+                      ((uint64_t)usage.ru_utime.tv_usec + (uint64_t)usage.ru_stime.tv_usec) * 1000ULL;
+    result->out = capture_finish(&captures[0], &result->out_len);
+    result->err = capture_finish(&captures[1], &result->err_len);
+    if (cancelled) result->status = HR_PLATFORM_CANCELLED;
+    else if (waited == pid && WIFEXITED(status)) result->status = WEXITSTATUS(status);
+    return result->status;
+}
+
+void hr_platform_process_result_free(hr_process_result_t* result) {
+    if (!result) return;
+    free(result->out);
+    free(result->err);
+    result->out = result->err = NULL;
+    result->out_len = result->err_len = 0;
+}
+
+static void* thread_main(void* arg) {
+    hr_thread_t* t = (hr_thread_t*)arg;
+    t->fn(t->arg);
+    return NULL;
+}
+
+hr_thread_t* hr_platform_thread_start(hr_thread_fn fn, void* arg) {
+    hr_thread_t* t = calloc(1, sizeof(hr_thread_t));
+    if (!t) return NULL;
+    t->fn  = fn;
+    t->arg = arg;
+    if (pthread_create(&t->id, NULL, thread_main, t) != 0) { free(t); return NULL; }
+    return t;
+}
+
+void hr_platform_thread_join(hr_thread_t* thread) {
+    if (!thread) return;
+    pthread_join(thread->id, NULL);
+    free(thread);
+}
+
+hr_mutex_t* hr_platform_mutex_create(void) {
+    hr_mutex_t* m = calloc(1, sizeof(hr_mutex_t));
+    if (m) pthread_mutex_init(&m->m, NULL);
+    return m;
+}
+
+void hr_platform_mutex_destroy(hr_mutex_t* mutex) {
+    if (!mutex) return;
+    pthread_mutex_destroy(&mutex->m);
+    free(mutex);
+}
+
+void hr_platform_mutex_lock(hr_mutex_t* mutex)   { pthread_mutex_lock(&mutex->m); }
+void hr_platform_mutex_unlock(hr_mutex_t* mutex) { pthread_mutex_unlock(&mutex->m); }
+
+hr_cond_t* hr_platform_cond_create(void) {
+    hr_cond_t* c = calloc(1, sizeof(hr_cond_t));
+    if (c) pthread_cond_init(&c->c, NULL);
+    return c;
+}
+
+void hr_platform_cond_destroy(hr_cond_t* cond) {
+    if (!cond) return;
+    pthread_cond_destroy(&cond->c);
+    free(cond);
+}
+
+void hr_platform_cond_wait(hr_cond_t* cond, hr_mutex_t* mutex) {
+    pthread_cond_wait(&cond->c, &mutex->m);
+}
+
+void hr_platform_cond_broadcast(hr_cond_t* cond) {
+    pthread_cond_broadcast(&cond->c);
+}
+
+uint64_t hr_platform_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int hr_platform_realpath(const char* path, char* out, size_t out_size) {
+    char resolved[PATH_MAX];
+    if (!realpath(path, resolved)) return 0;
+    if (strlen(resolved) >= out_size) return 0;
+    strcpy(out, resolved);
+    return 1;
+}
+
+int64_t hr_platform_file_size(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) return -1;
+    return (int64_t)st.st_size;
+}
+
+int hr_platform_file_touch(const char* path) {
+    return utimes(path, NULL) == 0;
+}
+
+int hr_platform_copy_file(const char* from, const char* to) {
+    int in = open(from, O_RDONLY);
+    if (in < 0) return 0;
+    int out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+    if (out < 0) { close(in); return 0; }
+
+    char buf[65536];
+    ssize_t n;
+    int ok = 1;
+    while (ok && (n = read(in, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ok = 0;
+            break;
+        }
+        for (ssize_t off = 0; off < n; ) {
+            ssize_t w = write(out, buf + off, (size_t)(n - off));
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) { ok = 0; break; }
+            off += w;
+        }
+    }
+    close(in);
+    if (close(out) != 0) ok = 0;
+    if (!ok) remove(to);
+    return ok;
+}
+
+int hr_platform_rename(const char* from, const char* to) {
+    return rename(from, to) == 0;
+}
+
+int hr_platform_list_dir(const char* dir, hr_dir_entry_cb cb, void* userdata) {
+    DIR* d = opendir(dir);
+    if (!d) return 0;
+    struct dirent* e;
+    char path[4096];
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        struct stat st;
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        cb(path, (int64_t)st.st_size, (int64_t)st.st_mtime, userdata);
+    }
+    closedir(d);
+    return 1;
+}
+
+int hr_platform_find_program(const char* name, char* out, size_t out_size) {
+    if (strchr(name, '/'))
+        return access(name, X_OK) == 0 && hr_platform_realpath(name, out, out_size);
+    const char* env = getenv("PATH");
+    if (!env) env = "/usr/local/bin:/usr/bin:/bin";
+    char candidate[4096];
+    while (*env) {
+        const char* end = strchr(env, ':');
+        size_t len = end ? (size_t)(end - env) : strlen(env);
+        if (len == 0) snprintf(candidate, sizeof(candidate), "./%s", name);
+        else          snprintf(candidate, sizeof(candidate), "%.*s/%s", (int)len, env, name);
+        if (access(candidate, X_OK) == 0)
+            return hr_platform_realpath(candidate, out, out_size);
+        if (!end) break;
+        env = end + 1;
+    }
+    return 0;
+}
+
+hr_file_lock_t* hr_platform_file_trylock(const char* path) {
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return NULL;
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return NULL;
+    }
+    struct stat held, current;
+    if (fstat(fd, &held) != 0 || stat(path, &current) != 0 ||
+        held.st_ino != current.st_ino || held.st_dev != current.st_dev) {
+        close(fd);
+        return NULL;
+    }
+    hr_file_lock_t* lock = malloc(sizeof(hr_file_lock_t));
+    if (!lock) { close(fd); return NULL; }
+    lock->fd = fd;
+    snprintf(lock->path, sizeof(lock->path), "%s", path);
+    return lock;
+}
+
+void hr_platform_file_unlock(hr_file_lock_t* lock) {
+    if (!lock) return;
+    unlink(lock->path);
+    close(lock->fd);
+    free(lock);
+}
+
+int hr_platform_process_id(void) {
+    return (int)getpid();
+}
+
+const void* hr_platform_map_file(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return NULL; }
+    void* addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return NULL;
+    *size = (size_t)st.st_size;
+    return addr;
+}
+
+void hr_platform_unmap_file(const void* addr, size_t size) {
+    if (addr) munmap((void*)addr, size);
+}
+
+int hr_platform_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+#define HR_NEAR_STEP ((uintptr_t)64 << 20)
+
+/* Asks for mappings at growing distances on both sides of `near` and keeps
+   the first one whose every byte is within `range` of it. The kernel takes
+   the hint as is when the address is free. */
+void* hr_platform_alloc_exec_near(const void* near, size_t size, uint64_t range) {
+    uintptr_t center = (uintptr_t)near & ~(HR_NEAR_STEP - 1);
+    for (uintptr_t step = 0; step < range; step += HR_NEAR_STEP) {
+        for (int side = 0; side < 2; side++) {
+            if (step == 0 && side == 1) continue;
+            if (side == 0 && center < step) continue;
+            uintptr_t hint = side == 0 ? center - step : center + step;
+            void* p = mmap((void*)hint, size, PROT_READ | PROT_WRITE | PROT_EXEC,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) continue;
+            uintptr_t lo = (uintptr_t)p, hi = lo + size, at = (uintptr_t)near;
+            uint64_t below = at > lo ? at - lo : 0;
+            uint64_t above = hi > at ? hi - at : 0;
+            if (below < range && above < range) return p;
+            munmap(p, size);
+        }
+    }
+    return NULL;
+}
+
+size_t hr_platform_page_size(void) {
+    long n = sysconf(_SC_PAGESIZE);
+    return n > 0 ? (size_t)n : 4096;
+}
+
+#endif
@@ -13,13 +13,22 @@ struct hr_watcher_handle {
     hr_file_changed_cb cb;
     void* userdata;
     char watch_dir[4096];
+    char exclude_dir[4096];
+    BOOL recursive;
+    uint64_t startup_ns;
     OVERLAPPED overlapped;
     char notify_buf[65536];
 };
 
-hr_watcher_handle_t* hr_platform_watch_start(const char* dir, hr_file_changed_cb cb, void* userdata) {
+hr_watcher_handle_t* hr_platform_watch_start(const char* dir, const hr_watch_options_t* opts,
+                                             hr_file_changed_cb cb, void* userdata) {
     hr_watcher_handle_t* h = calloc(1, sizeof(hr_watcher_handle_t));
     if (!h) return NULL;
+    uint64_t t0 = hr_platform_time_ns();
+    h->recursive = opts && opts->recursive;
+    if (opts && opts->exclude_dir &&
+        !hr_platform_realpath(opts->exclude_dir, h->exclude_dir, sizeof(h->exclude_dir)))
+        h->exclude_dir[0] = 0;
     h->dir_handle = CreateFileA(dir, FILE_LIST_DIRECTORY,
         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
         NULL, OPEN_EXISTING,
@@ -28,12 +37,14 @@ hr_watcher_handle_t* hr_platform_watch_start(const char* dir, hr_file_changed_cb
     h->stop_event = CreateEvent(NULL, TRUE, FALSE, NULL);
     h->cb = cb;
     h->userdata = userdata;
-    strncpy(h->watch_dir, dir, sizeof(h->watch_dir) - 1);
+    if (!hr_platform_realpath(dir, h->watch_dir, sizeof(h->watch_dir)))
+        strncpy(h->watch_dir, dir, sizeof(h->watch_dir) - 1);
     memset(&h->overlapped, 0, sizeof(h->overlapped));
     h->overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
     ReadDirectoryChangesW(h->dir_handle, h->notify_buf, sizeof(h->notify_buf),
-        FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+        h->recursive, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
         NULL, &h->overlapped, NULL);
+    h->startup_ns = hr_platform_time_ns() - t0;
     return h;
 }
 
@@ -61,7 +72,9 @@ void hr_platform_watch_poll(hr_watcher_handle_t* handle) {
             filename[len] = 0;
             char full_path[8192];
             snprintf(full_path, sizeof(full_path), "%s\\%s", handle->watch_dir, filename);
-            handle->cb(full_path, handle->userdata);
+            size_t ex = strlen(handle->exclude_dir);
+            if (!ex || _strnicmp(full_path, handle->exclude_dir, ex) != 0)
+                handle->cb(full_path, handle->userdata);
         }
         if (info->NextEntryOffset == 0) break;
         info = (FILE_NOTIFY_INFORMATION*)((char*)info + info->NextEntryOffset);
@@ -70,14 +83,42 @@ requeue:
     ResetEvent(handle->overlapped.hEvent);
     memset(handle->notify_buf, 0, sizeof(handle->notify_buf));
     ReadDirectoryChangesW(handle->dir_handle, handle->notify_buf, sizeof(handle->notify_buf),
-        FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+        handle->recursive, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
         NULL, &handle->overlapped, NULL);
 }
 
+void hr_platform_watch_info(const hr_watcher_handle_t* handle, hr_watch_info_t* out) {
+    memset(out, 0, sizeof(*out));
+    if (!handle) return;
+    out->directories  = 1;
+    out->memory_bytes = sizeof(*handle);
+    out->startup_ns   = handle->startup_ns;
+}
+
 void* hr_platform_alloc_exec(size_t size) {
     return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
 }
 
+/* VirtualAlloc only places a region at an address aligned to the
+   allocation granularity, and fails instead of moving it when taken. */
+void* hr_platform_alloc_exec_near(const void* near, size_t size, uint64_t range) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    uintptr_t step   = (uintptr_t)info.dwAllocationGranularity;
+    uintptr_t center = (uintptr_t)near & ~(step - 1);
+    for (uintptr_t offset = 0; offset + size < range; offset += step) {
+        if (center + offset + size - (uintptr_t)near < range) {
+            void* p = VirtualAlloc((void*)(center + offset), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+            if (p) return p;
+        }
+        if (offset && center >= offset && (uintptr_t)near - (center - offset) < range) {
+            void* p = VirtualAlloc((void*)(center - offset), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+            if (p) return p;
+        }
+    }
+    return NULL;
+}
+
 void hr_platform_free_exec(void* addr, size_t size) {
     (void)size;
     VirtualFree(addr, 0, MEM_RELEASE);
@@ -85,7 +126,7 @@ void hr_platform_free_exec(void* addr, size_t size) {
 
 int hr_platform_make_writable(void* addr, size_t size) {
     DWORD old;
-    return VirtualProtect(addr, size, PAGE_READWRITE, &old) != 0;
+    return VirtualProtect(addr, size, PAGE_EXECUTE_READWRITE, &old) != 0;
 }
 
 int hr_platform_make_executable(void* addr, size_t size) {
@@ -93,6 +134,11 @@ int hr_platform_make_executable(void* addr, size_t size) {
     return VirtualProtect(addr, size, PAGE_EXECUTE_READ, &old) != 0;
 }
 
+int hr_platform_protect_data(void* addr, size_t size, int writable) {
+    DWORD old;
+    return VirtualProtect(addr, size, writable ? PAGE_READWRITE : PAGE_READONLY, &old) != 0;
+}
+
 void* hr_platform_lib_open(const char* path) {
     return (void*)LoadLibraryA(path);
 }
@@ -105,6 +151,11 @@ int hr_platform_lib_close(void* handle) {
     return FreeLibrary((HMODULE)handle) != 0;
 }
 
+int hr_platform_lib_base(void* handle, uintptr_t* base) {
+    (void)handle; (void)base;
+    return 0;
+}
+
 const char* hr_platform_lib_error(void) {
     static char buf[256];
     FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM, NULL, GetLastError(), 0, buf, sizeof(buf), NULL);
@@ -137,40 +188,334 @@ int hr_platform_mkdir(const char* path) {
     return CreateDirectoryA(tmp, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
 }
 
-int hr_platform_run_command(const char* cmd, char* output, size_t output_size) {
+int64_t hr_platform_file_size(const char* path) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return -1;
+    return ((int64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+}
+
+int hr_platform_file_touch(const char* path) {
+    HANDLE h = CreateFileA(path, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                           NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return 0;
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    BOOL ok = SetFileTime(h, NULL, NULL, &now);
+    CloseHandle(h);
+    return ok != 0;
+}
+
+int hr_platform_copy_file(const char* from, const char* to) {
+    return CopyFileA(from, to, FALSE) != 0;
+}
+
+int hr_platform_rename(const char* from, const char* to) {
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+int hr_platform_list_dir(const char* dir, hr_dir_entry_cb cb, void* userdata) {
+    char pattern[4096];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(pattern, &fd);
+    if (h == INVALID_HANDLE_VALUE) return 0;
+    char path[4096];
+    do {
+        if (fd.cFileName[0] == '.' || (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) continue;
+        snprintf(path, sizeof(path), "%s\\%s", dir, fd.cFileName);
+        ULARGE_INTEGER mtime;
+        mtime.LowPart  = fd.ftLastWriteTime.dwLowDateTime;
+        mtime.HighPart = fd.ftLastWriteTime.dwHighDateTime;
+        cb(path, ((int64_t)fd.nFileSizeHigh << 32) | fd.nFileSizeLow, (int64_t)mtime.QuadPart, userdata);
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+    return 1;
+}
+
+int hr_platform_find_program(const char* name, char* out, size_t out_size) {
+    char found[MAX_PATH];
+    if (!SearchPathA(NULL, name, ".exe", sizeof(found), found, NULL)) return 0;
+    return hr_platform_realpath(found, out, out_size);
+}
+
+struct hr_file_lock {
+    HANDLE handle;
+};
+
+hr_file_lock_t* hr_platform_file_trylock(const char* path) {
+    HANDLE h = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS,
+                           FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    if (h == INVALID_HANDLE_VALUE) return NULL;
+    hr_file_lock_t* lock = malloc(sizeof(hr_file_lock_t));
+    if (!lock) { CloseHandle(h); return NULL; }
+    lock->handle = h;
+    return lock;
+}
+
+void hr_platform_file_unlock(hr_file_lock_t* lock) {
+    if (!lock) return;
+    CloseHandle(lock->handle);
+    free(lock);
+}
+
+int hr_platform_process_id(void) {
+    return (int)GetCurrentProcessId();
+}
+
+const void* hr_platform_map_file(const char* path, size_t* size) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    LARGE_INTEGER len;
+    if (!GetFileSizeEx(file, &len) || len.QuadPart == 0) { CloseHandle(file); return NULL; }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return NULL;
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view) *size = (size_t)len.QuadPart;
+    return view;
+}
+
+void hr_platform_unmap_file(const void* addr, size_t size) {
+    (void)size;
+    if (addr) UnmapViewOfFile(addr);
+}
+
+static __declspec(thread) volatile int* t_cancel_flag;
+
+void hr_platform_set_cancel_flag(volatile int* flag) {
+    t_cancel_flag = flag;
+}
+
+typedef struct {
+    char*  data;
+    size_t len;
+    size_t cap;
+} hr_capture_t;
+
+static int capture_append(hr_capture_t* cap, const char* src, size_t n) {
+    if (cap->len + n + 1 > cap->cap) {
+        size_t size = cap->cap ? cap->cap : 8192;
+        while (size < cap->len + n + 1) size *= 2;
+        char* data = realloc(cap->data, size);
+        if (!data) return 0;
+        cap->data = data;
+        cap->cap  = size;
+    }
+    memcpy(cap->data + cap->len, src, n);
+    cap->len += n;
+    cap->data[cap->len] = 0;
+    return 1;
+}
+
+static int drain_pipe(HANDLE pipe, hr_capture_t* cap) {
+    DWORD avail = 0;
+    if (!PeekNamedPipe(pipe, NULL, 0, NULL, &avail, NULL)) return -1;
+    if (avail == 0) return 0;
+    char  buf[4096];
+    DWORD n;
+    if (!ReadFile(pipe, buf, avail < sizeof(buf) ? avail : (DWORD)sizeof(buf), &n, NULL) || n == 0) return -1;
+    return capture_append(cap, buf, n) ? (int)n : -1;
+}
+
+static void quote_arg(hr_capture_t* line, const char* arg) {
+    if (line->len) capture_append(line, " ", 1);
+    if (*arg && !strpbrk(arg, " \t\n\v\"")) {
+        capture_append(line, arg, strlen(arg));
+        return;
+    }
+    capture_append(line, "\"", 1);
+    for (const char* p = arg; ; p++) {
+        size_t slashes = 0;
+        while (*p == '\\') { slashes++; p++; }
+        if (!*p) {
+            for (size_t i = 0; i < slashes * 2; i++) capture_append(line, "\\", 1);
+            break;
+        }
+        if (*p == '"') slashes = slashes * 2 + 1;
+        for (size_t i = 0; i < slashes; i++) capture_append(line, "\\", 1);
+        capture_append(line, p, 1);
+    }
+    capture_append(line, "\"", 1);
+}
+
+static uint64_t filetime_ns(FILETIME ft) {
+    return (((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime) * 100ULL;
+}
+
+int hr_platform_spawn(const char* const* argv, hr_process_result_t* result) {
+    memset(result, 0, sizeof(*result));
+    result->status = -1;
+    hr_capture_t line = {0};
+    for (int i = 0; argv[i]; i++) quote_arg(&line, argv[i]);
+    if (!line.data) return -1;
+
     SECURITY_ATTRIBUTES sa = { sizeof(sa), NULL, TRUE };
-    HANDLE read_pipe, write_pipe;
-    if (!CreatePipe(&read_pipe, &write_pipe, &sa, 0)) return -1;
-    SetHandleInformation(read_pipe, HANDLE_FLAG_INHERIT, 0);
+    HANDLE out_read, out_write, err_read, err_write;
+    if (!CreatePipe(&out_read, &out_write, &sa, 0)) { free(line.data); return -1; }
+    if (!CreatePipe(&err_read, &err_write, &sa, 0)) {
+        CloseHandle(out_read); CloseHandle(out_write); free(line.data); return -1;
+    }
+    SetHandleInformation(out_read, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(err_read, HANDLE_FLAG_INHERIT, 0);
+    HANDLE null_in = CreateFileA("NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &sa,
+                                 OPEN_EXISTING, 0, NULL);
     STARTUPINFOA si = { sizeof(si) };
-    si.dwFlags = STARTF_USESTDHANDLES;
-    si.hStdOutput = write_pipe;
-    si.hStdError  = write_pipe;
-    si.hStdInput  = GetStdHandle(STD_INPUT_HANDLE);
+    si.dwFlags    = STARTF_USESTDHANDLES;
+    si.hStdOutput = out_write;
+    si.hStdError  = err_write;
+    si.hStdInput  = null_in;
     PROCESS_INFORMATION pi;
-    char cmd_buf[8192];
-    snprintf(cmd_buf, sizeof(cmd_buf), "cmd /c %s", cmd);
-    if (!CreateProcessA(NULL, cmd_buf, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi)) {
-        CloseHandle(read_pipe); CloseHandle(write_pipe); return -1;
+    uint64_t start = hr_platform_time_ns();
+    BOOL created = CreateProcessA(NULL, line.data, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
+    CloseHandle(out_write);
+    CloseHandle(err_write);
+    if (null_in != INVALID_HANDLE_VALUE) CloseHandle(null_in);
+    free(line.data);
+    if (!created) {
+        fprintf(stderr, "[hr:platform] cannot run %s: error %lu\n", argv[0], GetLastError());
+        CloseHandle(out_read); CloseHandle(err_read); return -1;
     }
-    CloseHandle(write_pipe);
-    if (output && output_size > 0) {
-        DWORD total = 0, n;
-        while (total < (DWORD)output_size - 1 &&
-               ReadFile(read_pipe, output+total, (DWORD)(output_size-1-total), &n, NULL) && n > 0)
-            total += n;
-        output[total] = 0;
+
+    hr_capture_t captures[2] = {{0}, {0}};
+    HANDLE pipes[2] = { out_read, err_read };
+    int open_pipes = 2;
+    int cancelled  = 0;
+    while (open_pipes > 0) {
+        if (!cancelled && t_cancel_flag && *t_cancel_flag) {
+            TerminateProcess(pi.hProcess, 1);
+            cancelled = 1;
+        }
+        int progress = 0;
+        for (int i = 0; i < 2; i++) {
+            if (!pipes[i]) continue;
+            int n = drain_pipe(pipes[i], &captures[i]);
+            if (n < 0) {
+                CloseHandle(pipes[i]);
+                pipes[i] = NULL;
+                open_pipes--;
+            }
+            if (n != 0) progress = 1;
+        }
+        if (!progress) WaitForSingleObject(pi.hProcess, 20);
     }
     WaitForSingleObject(pi.hProcess, INFINITE);
-    DWORD exit_code;
+    result->wall_ns = hr_platform_time_ns() - start;
+    FILETIME created_at, exited_at, kernel, user;
+    if (GetProcessTimes(pi.hProcess, &created_at, &exited_at, &kernel, &user))
+        result->cpu_ns = filetime_ns(kernel) + filetime_ns(user);
+    DWORD exit_code = 1;
     GetExitCodeProcess(pi.hProcess, &exit_code);
     CloseHandle(pi.hProcess);
     CloseHandle(pi.hThread);
-    CloseHandle(read_pipe);
-    return (int)exit_code;
+
+    result->out     = captures[0].data ? captures[0].data : calloc(1, 1);
+    result->out_len = captures[0].len;
+    result->err     = captures[1].data ? captures[1].data : calloc(1, 1);
+    result->err_len = captures[1].len;
+    result->status  = cancelled ? HR_PLATFORM_CANCELLED : (int)exit_code;
+    return result->status;
+}
+
+void hr_platform_process_result_free(hr_process_result_t* result) {
+    if (!result) return;
+    free(result->out);
+    free(result->err);
+    result->out = result->err = NULL;
+    result->out_len = result->err_len = 0;
+}
+
+struct hr_thread {
+    HANDLE       handle;
+    hr_thread_fn fn;
+    void*        arg;
+};
+
+struct hr_mutex {
+    SRWLOCK lock;
+};
+
+struct hr_cond {
+    CONDITION_VARIABLE cv;
+};
+
+static DWORD WINAPI thread_main(LPVOID arg) {
+    hr_thread_t* t = (hr_thread_t*)arg;
+    t->fn(t->arg);
+    return 0;
+}
+
+hr_thread_t* hr_platform_thread_start(hr_thread_fn fn, void* arg) {
+    hr_thread_t* t = calloc(1, sizeof(hr_thread_t));
+    if (!t) return NULL;
+    t->fn  = fn;
+    t->arg = arg;
+    t->handle = CreateThread(NULL, 0, thread_main, t, 0, NULL);
+    if (!t->handle) { free(t); return NULL; }
+    return t;
+}
+
+void hr_platform_thread_join(hr_thread_t* thread) {
+    if (!thread) return;
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    free(thread);
+}
+
+hr_mutex_t* hr_platform_mutex_create(void) {
+    hr_mutex_t* m = calloc(1, sizeof(hr_mutex_t));
+    if (m) InitializeSRWLock(&m->lock);
+    return m;
+}
+
+void hr_platform_mutex_destroy(hr_mutex_t* mutex) { free(mutex); }
+void hr_platform_mutex_lock(hr_mutex_t* mutex)    { AcquireSRWLockExclusive(&mutex->lock); }
+void hr_platform_mutex_unlock(hr_mutex_t* mutex)  { ReleaseSRWLockExclusive(&mutex->lock); }
+
+hr_cond_t* hr_platform_cond_create(void) {
+    hr_cond_t* c = calloc(1, sizeof(hr_cond_t));
+    if (c) InitializeConditionVariable(&c->cv);
+    return c;
+}
+
+void hr_platform_cond_destroy(hr_cond_t* cond) { free(cond); }
+
+void hr_platform_cond_wait(hr_cond_t* cond, hr_mutex_t* mutex) {
+    SleepConditionVariableSRW(&cond->cv, &mutex->lock, INFINITE, 0);
+}
+
+void hr_platform_cond_broadcast(hr_cond_t* cond) {
+    WakeAllConditionVariable(&cond->cv);
+}
+
+uint64_t hr_platform_time_ns(void) {
+    static LARGE_INTEGER freq;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER c;
+    QueryPerformanceCounter(&c);
+    return (uint64_t)((double)c.QuadPart * 1e9 / (double)freq.QuadPart);
+}
+
+int hr_platform_realpath(const char* path, char* out, size_t out_size) {
+    return _fullpath(out, path, out_size) != NULL;
+}
+
+int hr_platform_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+size_t hr_platform_page_size(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize > 0 ? (size_t)info.dwPageSize : 4096;
 }
 
-void hr_platform_thread_pause_others(void) {}
+int hr_platform_thread_pause_others(void) { return 0; }
+uintptr_t hr_platform_thread_paused_ip(int index) { (void)index; return 0; }
+int hr_platform_thread_step(hr_ip_filter_fn busy, void* userdata) { (void)busy; (void)userdata; return 0; }
 void hr_platform_thread_resume_others(void) {}
 
 void hr_platform_sleep_ms(int ms) {